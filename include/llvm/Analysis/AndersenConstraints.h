@@ -0,0 +1,38 @@
+//===- llvm/Analysis/AndersenConstraints.h - offline Andersen solving -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the entry point for solving the constraint files written
+// by AndersenPass with -andersen-write-constraints, without any IR.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ANALYSIS_ANDERSENCONSTRAINTS_H
+#define LLVM_ANALYSIS_ANDERSENCONSTRAINTS_H
+
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace llvm {
+
+class raw_ostream;
+
+/// solveAndersenConstraints - Solve the points-to set of every named id in the
+/// constraint file in Buffer, and print one line per id to OS:
+///
+///   #<id> <name> = { #<id> <name>, ... }
+///
+/// with the elements sorted by id. Returns false and sets ErrorInfo if Buffer
+/// is not a valid constraint file.
+bool solveAndersenConstraints(StringRef Buffer, raw_ostream &OS,
+                              std::string &ErrorInfo);
+
+}
+
+#endif
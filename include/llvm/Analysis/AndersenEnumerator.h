@@ -15,12 +15,16 @@
 #ifndef LLVM_ANALYSIS_ANDERSENENUMERATOR_H
 #define LLVM_ANALYSIS_ANDERSENENUMERATOR_H
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+
 #include <cstddef>
 
 namespace llvm {
 namespace andersen_internal {
 
 class AnalysisResult;
+class EnumerationSession;
 class ValueInfo;
 
 }
@@ -28,16 +32,39 @@ class ValueInfo;
 
 namespace llvm {
 
+// If AR holds the universe of its Data, the elements of the universe that AR
+// does not list itself follow those that it does.
 class AndersenEnumerator {
   andersen_internal::AnalysisResult *AR;
-  size_t i;
+  uint32_t i;
+  // Position in the universe, once past the end of AR.
+  uint32_t j;
 
 public:
-  explicit AndersenEnumerator(
-      andersen_internal::AnalysisResult *AR, size_t i = 0) : AR(AR), i(i) {}
+  // Enumerate AR from position i, then from position j of the universe.
+  explicit AndersenEnumerator(andersen_internal::AnalysisResult *AR,
+                              uint32_t i = 0, uint32_t j = 0)
+    : AR(AR), i(i), j(j) {}
 
   // Get next VI or null if done.
   andersen_internal::ValueInfo *enumerate();
+
+  // Like enumerate(), but accounts the work to Session. Also returns null if
+  // Session runs out of budget, which Session->isSuspended() distinguishes
+  // from the end of the set. Enumeration can be resumed later.
+  andersen_internal::ValueInfo *enumerate(
+      andersen_internal::EnumerationSession *Session);
+
+  // Append all elements that are already computed to Out, then compute and
+  // append up to Max more. Returns false if the end of the set was reached.
+  // Cheaper than calling enumerate() for each element when scanning a set.
+  bool enumerate(SmallVectorImpl<andersen_internal::ValueInfo *> &Out,
+                 size_t Max);
+
+  // Like the above, but accounts the work to Session. Also returns false if
+  // Session runs out of budget.
+  bool enumerate(SmallVectorImpl<andersen_internal::ValueInfo *> &Out,
+                 size_t Max, andersen_internal::EnumerationSession *Session);
 };
 
 }
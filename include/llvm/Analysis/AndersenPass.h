@@ -15,14 +15,24 @@
 #ifndef LLVM_ANALYSIS_ANDERSENPASS_H
 #define LLVM_ANALYSIS_ANDERSENPASS_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Pass.h"
 
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
 namespace llvm {
 namespace andersen_internal {
 
 class AnalysisResult;
+class BackgroundSolver;
+class CostAttribution;
 class Data;
+class EnumerationSession;
+class EnumerationTrace;
 class ValueInfo;
 
 }
@@ -36,11 +46,93 @@ class Value;
 typedef SetVector<andersen_internal::ValueInfo *> PointsToSet;
 typedef andersen_internal::AnalysisResult *AndersenHandle;
 
+/// PointsToSetView - A view of the points-to set of a value, in the order the
+/// elements were found, followed by those it holds through the universe of
+/// escaped memory if it is known to hold that. Unlike a PointsToSet, it holds
+/// no copy of the elements. It refers to the data of the AndersenPass that
+/// returned it, so it is only valid until that releases its memory.
+class PointsToSetView {
+  const andersen_internal::Data *D;
+  // Null for the empty set.
+  const andersen_internal::AnalysisResult *AR;
+  // The number of elements AR lists itself, and the number of elements of the
+  // universe, if AR is done and holds it, when the view was made.
+  size_t NumListed;
+  size_t NumUniverse;
+
+public:
+  class const_iterator
+      : public std::iterator<std::forward_iterator_tag,
+                             andersen_internal::ValueInfo *> {
+    const andersen_internal::Data *D;
+    const andersen_internal::AnalysisResult *AR;
+    size_t NumListed;
+    // Position in the elements AR lists, then NumListed plus the position in
+    // the universe.
+    size_t i;
+    size_t End;
+
+    // Move past the elements of the universe that AR lists itself.
+    void skipListed();
+
+  public:
+    const_iterator(const PointsToSetView &Set, size_t i)
+      : D(Set.D), AR(Set.AR), NumListed(Set.NumListed), i(i),
+        End(Set.NumListed + Set.NumUniverse) {
+      skipListed();
+    }
+
+    andersen_internal::ValueInfo *operator*() const;
+
+    const_iterator &operator++() {
+      ++i;
+      skipListed();
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator Old(*this);
+      ++*this;
+      return Old;
+    }
+
+    bool operator==(const const_iterator &that) const { return i == that.i; }
+    bool operator!=(const const_iterator &that) const { return i != that.i; }
+  };
+
+  friend class const_iterator;
+
+  // The empty set.
+  PointsToSetView() : D(0), AR(0), NumListed(0), NumUniverse(0) {}
+
+  // The contents of AR computed so far.
+  PointsToSetView(const andersen_internal::Data *D,
+                  const andersen_internal::AnalysisResult *AR);
+
+  // Linear in the number of elements held through the universe.
+  size_t size() const;
+  bool empty() const { return !NumListed && !NumUniverse; }
+  bool count(const andersen_internal::ValueInfo *VI) const;
+
+  const_iterator begin() const { return const_iterator(*this, 0); }
+  const_iterator end() const {
+    return const_iterator(*this, NumListed + NumUniverse);
+  }
+};
+
 /// AndersenPass - An LLVM pass which implements Andersen's algorithm for
 /// points-to analysis with some modifications for lazy evaluation.
 class AndersenPass : public ModulePass {
+  friend class AndersenExplainPrinter;
   friend class AndersenGraphPass;
   andersen_internal::Data *Data;
+  // Solves sets ahead of queries with -andersen-background. Null otherwise.
+  andersen_internal::BackgroundSolver *Solver;
+  // Records queries and enumeration with -andersen-trace. Null otherwise.
+  andersen_internal::EnumerationTrace *Trace;
+  // Charges enumeration work to functions with -andersen-cost-report. Null
+  // otherwise.
+  andersen_internal::CostAttribution *Costs;
 
 public:
   static char ID; // Pass identification, replacement for typeid
@@ -50,12 +142,21 @@ public:
   // other methods.
   AndersenHandle getHandleToPointsToSet(const Value *V) const;
 
+  // Like getHandleToPointsToSet(V), but returns false if the points-to set of V
+  // is unknown because passes changed its function after the body was
+  // discarded and read in again, instead of treating V as pointing to nothing.
+  bool getHandleToPointsToSet(const Value *V, AndersenHandle &AH) const;
+
   // Get the points-to set of V, or null if V cannot point to anything. If the
   // points-to set has not yet been fully computed, this method computes it.
   // The elements should be treated as opaque ids for abstract memory regions in
   // the program.
   const PointsToSet *getPointsToSet(AndersenHandle AH) const;
 
+  // Like getPointsToSet(AH), but returns a view of the set instead of a copy,
+  // which is empty if V cannot point to anything.
+  PointsToSetView getPointsToSetView(AndersenHandle AH) const;
+
   // Equivalent to getPointsToSet(AH).empty(), but does not force computation of
   // the whole set.
   bool isPointsToSetEmpty(AndersenHandle AH) const;
@@ -66,15 +167,70 @@ public:
   AndersenEnumerator enumeratePointsToSet(AndersenHandle AH) const;
 
   // Get the contents of the points-to set of V that have so far been
-  // computed, or null if V cannot point to anything.
+  // computed, or null if V cannot point to anything. With
+  // -andersen-background, this computes the whole set first, since the thread
+  // would otherwise add to it while the set is read.
   const PointsToSet *getPointsToSetContentsSoFar(AndersenHandle AH) const;
 
+  // Like getPointsToSetContentsSoFar(AH), but returns a view of the contents
+  // instead of a copy, which is empty if V cannot point to anything.
+  PointsToSetView getPointsToSetContentsSoFarView(AndersenHandle AH) const;
+
   // Get an enumerator for any remaining contents of the points-to set of V
   // which have not yet been computed.
   AndersenEnumerator enumeratePointsToSetContentsRemaining(AndersenHandle AH)
       const;
 
+  // Returns true if the points-to sets of A and B have any element in common.
+  // Computes only as much of the sets as needed to answer.
+  bool doPointsToSetsIntersect(AndersenHandle A, AndersenHandle B) const;
+
+  // Like doPointsToSetsIntersect(A, B), but gives up after Budget units of
+  // enumeration work. Returns false if it gave up, else stores the answer in
+  // Result. Work done before giving up is kept, so later queries resume from
+  // there.
+  bool tryPointsToSetsIntersect(AndersenHandle A, AndersenHandle B,
+                                unsigned Budget, bool &Result) const;
+
+  // Batch version of getPointsToSet(getHandleToPointsToSet(V)). Results[i]
+  // receives the points-to set of Values[i]. Each distinct set is solved only
+  // once no matter how many of the Values share it, after the unfinished sets
+  // it reads, so that subsets shared across the batch are computed once.
+  void getPointsToSets(ArrayRef<const Value *> Values,
+                       MutableArrayRef<const PointsToSet *> Results) const;
+
+  // Like the above, but Results[i] receives a view of the set.
+  void getPointsToSets(ArrayRef<const Value *> Values,
+                       MutableArrayRef<PointsToSetView> Results) const;
+
+  // Batch version of doPointsToSetsIntersect for pairs of Values. Results[i]
+  // receives the answer for Pairs[i]. All the distinct sets involved are solved
+  // up front so that every pair can be answered from their finished forms.
+  void doPointsToSetsIntersect(
+      ArrayRef<std::pair<const Value *, const Value *> > Pairs,
+      MutableArrayRef<bool> Results) const;
+
+  // Print one chain of sets through which the region VI reached the points-to
+  // set AH, from AH back to the set that held VI from the start. Computes the
+  // set only as far as VI. The chain is only known with
+  // -andersen-record-derivations. Returns false if VI is not in the set.
+  bool explainMembership(AndersenHandle AH, andersen_internal::ValueInfo *VI,
+                         raw_ostream &OS) const;
+
 private:
+  bool intersect(AndersenHandle A, AndersenHandle B,
+                 andersen_internal::EnumerationSession *Session,
+                 bool &Result) const;
+  void solveAll(ArrayRef<AndersenHandle> Handles) const;
+  void solveAll(ArrayRef<const Value *> Values,
+                SmallVectorImpl<AndersenHandle> &Handles) const;
+  void solveAllByComponent() const;
+  void startBackgroundSolver(const Module &M);
+  void writeConstraintFile(const Module &M) const;
+  void startTrace();
+  void writeCostReport() const;
+  void relieveMemoryPressure() const;
+
   virtual bool runOnModule(Module &M);
   virtual void releaseMemory();
   virtual void getAnalysisUsage(AnalysisUsage &AU) const;
@@ -73,6 +73,7 @@ void initializeAliasDebuggerPass(PassRegistry&);
 void initializeAliasSetPrinterPass(PassRegistry&);
 void initializeAlwaysInlinerPass(PassRegistry&);
 void initializeAndersenAliasAnalysisPass(PassRegistry&);
+void initializeAndersenExplainPrinterPass(PassRegistry&);
 void initializeAndersenGraphPrinterPass(PassRegistry&);
 void initializeAndersenGraphViewerPass(PassRegistry&);
 void initializeAndersenPassPass(PassRegistry&);
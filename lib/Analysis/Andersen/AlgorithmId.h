@@ -24,10 +24,20 @@ class raw_ostream;
 namespace llvm {
 namespace andersen_internal {
 
+class AnalysisResult;
+class ValueInfo;
+
 class AlgorithmId {
 public:
+  typedef AnalysisResult *(*RecomputeFn)(ValueInfo *);
+
   virtual void printAlgorithmName(raw_ostream &OS) const = 0;
 
+  // If the results of this algorithm are intermediates that may be discarded
+  // once done and computed again on demand, the function that computes one.
+  // Else null.
+  virtual RecomputeFn getRecomputeFn() const { return 0; }
+
 protected:
   ~AlgorithmId() {}
 };
@@ -0,0 +1,110 @@
+//===- AliasClasses.cpp - precomputed alias classes -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type for a partition of finished points-to sets into
+// classes of equal sets, with a precomputed overlap relation between classes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AliasClasses.h"
+
+#include "AnalysisResult.h"
+#include "Data.h"
+#include "Phase.h"
+#include "PointsToAlgorithm.h"
+#include "ValueInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+// The overlap matrix is indexed with unsigned, so bound the class count such
+// that its square fits.
+const uint32_t MaxRepresentableClasses = 0xFFFF;
+
+}
+
+AliasClasses::AliasClasses(Data *D, uint32_t MaxClasses, size_t MaxSetSize)
+  : NumClasses(0) {
+  MaxClasses = std::min(MaxClasses, MaxRepresentableClasses);
+  typedef std::vector<uint32_t> IdVector;
+  typedef std::map<IdVector, uint32_t> ClassMap;
+  typedef DenseMap<uint32_t, SmallVector<uint32_t, 4> > ClassesByElementMap;
+  ClassMap Classes;
+  ClassesByElementMap ClassesByElement;
+  std::vector<ValueInfo *> VIs;
+  for (ValueInfoMap::const_iterator i = D->ValueInfos.begin(),
+                                    End = D->ValueInfos.end();
+       i != End; ++i) {
+    VIs.push_back(i->second.getPtr());
+  }
+  for (FunctionBodyMap::const_iterator i = D->DematerializedValueInfos.begin(),
+                                       End = D->DematerializedValueInfos.end();
+       i != End; ++i) {
+    for (ValueInfoVector::const_iterator j = i->second.begin(),
+                                         JEnd = i->second.end();
+         j != JEnd; ++j) {
+      VIs.push_back(j->getPtr());
+    }
+  }
+  for (std::vector<ValueInfo *>::const_iterator i = VIs.begin(),
+                                                End = VIs.end();
+       i != End; ++i) {
+    ValueInfo *VI = *i;
+    if (!VI) continue;
+    AnalysisResult *AR =
+        VI->getAlgorithmResult<PointsToAlgorithm, ENUMERATION_PHASE>();
+    // Null if VI has no relations.
+    if (!AR || AR->getAliasClass() != AnalysisResult::NoAliasClass) continue;
+    const ValueInfoIdSetVector &Set = AR->getSetContentsSoFar();
+    // Sets that hold the universe are rarely small, and the universe would have
+    // to be copied to compare them.
+    if (!AR->isDone() || AR->containsUniverse() || Set.empty() ||
+        Set.size() > MaxSetSize) {
+      continue;
+    }
+    IdVector Ids(Set.begin(), Set.end());
+    std::sort(Ids.begin(), Ids.end());
+    ClassMap::iterator k = Classes.find(Ids);
+    if (k == Classes.end()) {
+      if (NumClasses == MaxClasses) continue;
+      k = Classes.insert(std::make_pair(Ids, NumClasses++)).first;
+      for (IdVector::const_iterator j = Ids.begin(), End = Ids.end();
+           j != End; ++j) {
+        ClassesByElement[*j].push_back(k->second);
+      }
+    }
+    AR->setAliasClass(k->second);
+  }
+  // Two classes overlap iff some element is in both.
+  MayOverlap.resize(NumClasses * NumClasses);
+  for (ClassesByElementMap::const_iterator i = ClassesByElement.begin(),
+                                           End = ClassesByElement.end();
+       i != End; ++i) {
+    const SmallVectorImpl<uint32_t> &Sharing = i->second;
+    for (SmallVectorImpl<uint32_t>::const_iterator j = Sharing.begin(),
+                                                   JEnd = Sharing.end();
+         j != JEnd; ++j) {
+      for (SmallVectorImpl<uint32_t>::const_iterator k = Sharing.begin();
+           k != JEnd; ++k) {
+        MayOverlap.set(*j * NumClasses + *k);
+      }
+    }
+  }
+}
+
+}
+}
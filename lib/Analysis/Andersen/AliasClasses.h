@@ -0,0 +1,50 @@
+//===- AliasClasses.h - precomputed alias classes -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type for a partition of finished points-to sets into
+// classes of equal sets, with a precomputed overlap relation between classes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ALIASCLASSES_H
+#define ALIASCLASSES_H
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <cassert>
+
+namespace llvm {
+namespace andersen_internal {
+
+class Data;
+
+class AliasClasses {
+  uint32_t NumClasses;
+  // Row-major NumClasses x NumClasses matrix. Bit (i, j) is set if the sets of
+  // classes i and j have an element in common.
+  BitVector MayOverlap;
+
+public:
+  // Assigns a class to the done, non-empty points-to sets of all Values in D
+  // with at most MaxSetSize elements, creating at most MaxClasses classes.
+  AliasClasses(Data *D, uint32_t MaxClasses, size_t MaxSetSize);
+
+  uint32_t getNumClasses() const { return NumClasses; }
+
+  bool mayOverlap(uint32_t A, uint32_t B) const {
+    assert(A < NumClasses && B < NumClasses);
+    return MayOverlap.test(A * NumClasses + B);
+  }
+};
+
+}
+}
+
+#endif
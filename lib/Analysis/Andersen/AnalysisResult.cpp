@@ -14,29 +14,69 @@
 #define DEBUG_TYPE "andersen"
 #include "AnalysisResult.h"
 
+#include "CostAttribution.h"
+#include "Data.h"
 #include "DebugInfo.h"
+#include "Derivations.h"
 #include "EnumerationContext.h"
 #include "EnumerationResult.h"
-#include "SubsetWork.h"
+#include "EnumerationSession.h"
+#include "EnumerationTrace.h"
+#include "FinishedSet.h"
 #include "ValueInfo.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
-#include <sstream>
+#include <vector>
 
 namespace llvm {
 namespace andersen_internal {
 
-AnalysisResult::AnalysisResult() : EnumerationDepth(-1) {}
+const uint32_t AnalysisResult::NoAliasClass;
+const uint32_t AnalysisResult::NoUnificationClass;
+
+AnalysisResult::AnalysisResult()
+  : EnumerationDepth(-1),
+    Id(0),
+    Owner(0),
+    Finished(0),
+    AliasClass(NoAliasClass),
+    UnificationClass(NoUnificationClass),
+    ContainsUniverse(false) {}
 
 AnalysisResult::~AnalysisResult() {
   assert(!isEnumerating());
+  delete Finished;
+}
+
+bool AnalysisResult::addValueInfo(const ValueInfo *VI) {
+  return addId(VI->getOwner(), VI->getId());
+}
+
+bool AnalysisResult::addId(Data &D, uint32_t VI) {
+  if (!Set.insert(VI)) {
+    return false;
+  }
+  ++D.NumSetElements;
+  return true;
+}
+
+void AnalysisResult::addUniverse(Data &D, const AnalysisResult *Source) {
+  if (ContainsUniverse || this == D.getUniverse()) {
+    return;
+  }
+  ContainsUniverse = true;
+  ++D.NumUniverseHolders;
+  if (Derivations *Derivs = Derivations::getActive()) {
+    Derivs->addUniverse(this, Source);
+  }
 }
 
-bool AnalysisResult::addValueInfo(ValueInfo *VI) {
-  return Set.insert(VI);
+bool AnalysisResult::countSoFar(const Data &D, uint32_t VI) const {
+  return Set.count(VI) ||
+         (ContainsUniverse && D.getUniverse()->Set.count(VI));
 }
 
 bool AnalysisResult::prepareForSubset(AnalysisResult *Subset) {
@@ -46,11 +86,20 @@ bool AnalysisResult::prepareForSubset(AnalysisResult *Subset) {
     return false;
   }
   // If we have added this subset to the work list before, don't add it again.
-  return Subsets.insert(Subset).second;
+  return Subsets.insert(Subset->Id);
 }
 
-EnumerationResult AnalysisResult::enumerate(int Depth, int LastTransformDepth,
-    size_t &i) {
+AnalysisResult *AnalysisResult::getWholeSubset() const {
+  if (!Set.empty() || ContainsUniverse || Work.size() != 1 ||
+      Work.front().getKind() != AnalysisResultWork::SUBSET ||
+      Work.front().getPosition() != 0) {
+    return 0;
+  }
+  return Work.front().getInput();
+}
+
+EnumerationResult AnalysisResult::enumerate(Data &D, int Depth,
+    int LastTransformDepth, uint32_t &i, EnumerationSession *Session) {
   assert(i <= Set.size());
   DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Enter " << this << '['
                << i << "]\n");
@@ -77,14 +126,44 @@ EnumerationResult AnalysisResult::enumerate(int Depth, int LastTransformDepth,
   }
   DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Run " << this << '['
                << i << "]\n");
-  EnumerationContext Ctx(this, Depth, LastTransformDepth);
+  EnumerationTrace::Span TraceSpan(this, Depth);
+  EnumerationContext Ctx(D, this, Depth, LastTransformDepth, Session);
   AnalysisResult *RetryCancellationPoint = 0;
-  while (Ctx.Pos != Work.end()) {
-    EnumerationResult ER = Ctx.Pos->enumerate(&Ctx);
+  // Number of sets holding the universe when this round over the work began.
+  uint32_t UniverseHolders = D.NumUniverseHolders;
+  for (;;) {
+    if (Ctx.Pos == Work.size()) {
+      // A set that came to hold the universe adds no element, so a cycle that
+      // got one in this round may still have work that missed it.
+      if (RetryCancellationPoint != this ||
+          UniverseHolders == D.NumUniverseHolders) {
+        break;
+      }
+      DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " In " << this
+                   << '[' << i << "]: retry for the universe\n");
+      Ctx.Pos = 0;
+      RetryCancellationPoint = 0;
+      UniverseHolders = D.NumUniverseHolders;
+    }
+    if (Session && !Session->step()) {
+      DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Leave " << this
+                   << '[' << i << "]: out of budget\n");
+      // All work is still in the list, so a later enumeration resumes here.
+      // Any work skipped for a retry is simply run again then.
+      return EnumerationResult::makeSuspendResult();
+    }
+    EnumerationResult ER = AnalysisResultWork::enumerate(&Ctx);
     switch (ER.getResultType()) {
     case EnumerationResult::NEXT_VALUE: {
-      ValueInfo *VI = ER.getNextValue();
-      if (addValueInfo(VI)) {
+      uint32_t VI = ER.getNextValue();
+      if (addId(D, VI)) {
+        if (Derivations *Derivs = Derivations::getActive()) {
+          Derivs->addSource(this, D.getValueInfo(VI),
+                            Ctx.getCurrentWork().getInput());
+        }
+        if (CostAttribution *C = CostAttribution::getActive()) {
+          C->addElement(this, Ctx.getCurrentWork().getInput());
+        }
         DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Leave " << this
                      << '[' << i << "]: computed " << VI << '\n');
         ++i;
@@ -98,8 +177,8 @@ EnumerationResult AnalysisResult::enumerate(int Depth, int LastTransformDepth,
     case EnumerationResult::INLINE:
       DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Leave " << this
                    << '[' << i << "]: inlining "
-                   << ER.getInlineEnumerator()->getAnalysisResult() << '['
-                   << ER.getInlineEnumerator()->getPosition() << ":]\n");
+                   << ER.getInlineEnumerator().getAnalysisResult() << '['
+                   << ER.getInlineEnumerator().getPosition() << ":]\n");
       return ER;
 
     case EnumerationResult::RETRY: {
@@ -128,23 +207,34 @@ EnumerationResult AnalysisResult::enumerate(int Depth, int LastTransformDepth,
       // Move all other work to the rewrite target and replace this work list
       // with a reference to it.
       AnalysisResult *RewriteTarget = ER.getRewriteTarget();
-      Ctx.Pos = Work.erase(Ctx.Pos);
+      Work.erase(Work.begin() + Ctx.Pos);
       if (RewriteTarget != this) {
         assert(RewriteTarget->EnumerationDepth < EnumerationDepth);
-        // Erase any work that shouldn't be moved.
-        for (AnalysisResultWorkList::iterator j = Work.begin();
-             j != Work.end(); ) {
+        // Move all work that should be moved to the target and drop the rest.
+        for (AnalysisResultWorkList::const_iterator j = Work.begin(),
+                                                    JEnd = Work.end();
+             j != JEnd; ++j) {
           if (j->prepareForRewrite(RewriteTarget)) {
-            ++j;
-          } else {
-            j = Work.erase(j);
+            RewriteTarget->Work.push_back(*j);
+            if (Derivations *Derivs = Derivations::getActive()) {
+              Derivs->moveSubset(this, j->getInput(), RewriteTarget,
+                                 j->getInput());
+            }
+            if (CostAttribution *C = CostAttribution::getActive()) {
+              C->moveSubset(this, j->getInput(), RewriteTarget,
+                            j->getInput());
+            }
           }
         }
-        // Splice all remaining objects to the target.
-        RewriteTarget->Work.splice(RewriteTarget->Work.end(), Work);
+        Work.clear();
+        // The subsets moved away are no longer covered by this AR's own work,
+        // so forget them. Otherwise inlining one of them later would wrongly
+        // be optimized away.
+        Subsets.clear();
+        Subsets.insert(RewriteTarget->Id);
         // Not using appendSubset here because it could incorrectly elide the
         // new entry.
-        Work.push_back(new SubsetWork(RewriteTarget));
+        Work.push_back(AnalysisResultWork::makeSubset(RewriteTarget));
         DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Leave " << this
                      << '[' << i << "]: rewriting " << RewriteTarget << '\n');
         return ER;
@@ -155,9 +245,14 @@ EnumerationResult AnalysisResult::enumerate(int Depth, int LastTransformDepth,
     }
 
     case EnumerationResult::COMPLETE:
-      Ctx.Pos = Work.erase(Ctx.Pos);
+      Work.erase(Work.begin() + Ctx.Pos);
       break;
 
+    case EnumerationResult::SUSPEND:
+      DEBUG(dbgs() << Depth << ':' << LastTransformDepth << " Leave " << this
+                   << '[' << i << "]: suspending\n");
+      return ER;
+
     default:
       llvm_unreachable("Not a recognized EnumerationResult");
       break;
@@ -190,22 +285,74 @@ EnumerationResult AnalysisResult::enumerate(int Depth, int LastTransformDepth,
   }
 }
 
+const FinishedSet &AnalysisResult::getFinishedSet(uint32_t NumValueInfos,
+    const FinishedSet *Universe) {
+  assert(isDone());
+  assert((!ContainsUniverse || Universe) && "Universe needed");
+  if (!Finished) {
+    std::vector<uint32_t> Ids(Set.begin(), Set.end());
+    Finished = new FinishedSet(Ids, NumValueInfos, Universe, ContainsUniverse);
+  }
+  return *Finished;
+}
+
+void AnalysisResult::collectInputs(DenseSet<AnalysisResult *> &Inputs) const {
+  for (AnalysisResultWorkList::const_iterator i = Work.begin(),
+                                              End = Work.end();
+       i != End; ++i) {
+    Inputs.insert(i->getInput());
+  }
+}
+
+void AnalysisResult::reset(Data &D, AnalysisResult *Fresh) {
+  assert(isDone() && !isEnumerating());
+  assert(Fresh->Set.empty() && !Fresh->Finished);
+  D.NumSetElements -= Set.size();
+  // Swap with the empty set of Fresh, since clear() keeps the storage.
+  Set.swap(Fresh->Set);
+  Subsets.swap(Fresh->Subsets);
+  Work.swap(Fresh->Work);
+  ContainsUniverse = false;
+  delete Finished;
+  Finished = 0;
+  delete Fresh;
+}
+
+void AnalysisResult::renumberElements(const std::vector<uint32_t> &NewIds) {
+  assert(!isEnumerating() && !Finished);
+  ValueInfoIdSetVector Renumbered;
+  for (ValueInfoIdSetVector::const_iterator i = Set.begin(), End = Set.end();
+       i != End; ++i) {
+    assert(*i < NewIds.size());
+    Renumbered.insert(NewIds[*i]);
+  }
+  Set.swap(Renumbered);
+}
+
 void AnalysisResult::writeEquation(const DebugInfo &DI, raw_ostream &OS) const {
   DI.printAnalysisResultName(this, OS);
   OS << " = ";
   bool first = true;
   if (!Set.empty()) {
     OS << '{';
-    ValueInfoSetVector::const_iterator i = Set.begin(), End = Set.end();
+    const Data &D = *DI.getData();
+    ValueInfoIdSetVector::const_iterator i = Set.begin(), End = Set.end();
     do {
       if (!first) {
         OS << ", ";
       }
       first = false;
-      DI.printValueInfoName(*i, OS);
+      DI.printValueInfoName(D.getValueInfo(*i), OS);
     } while (++i != End);
     OS << '}';
   }
+  if (ContainsUniverse) {
+    if (!first) {
+      OS << " U ";
+    }
+    first = false;
+    DI.printAnalysisResultName(DI.getData()->getUniverse(), OS);
+  }
   for (AnalysisResultWorkList::const_iterator i = Work.begin(),
                                               End = Work.end();
        i != End; ++i) {
@@ -222,24 +369,22 @@ void AnalysisResult::writeEquation(const DebugInfo &DI, raw_ostream &OS) const {
   OS << '\n';
 }
 
-GraphEdgeDeque AnalysisResult::getOutgoingEdges() const {
-  GraphEdgeDeque Result;
+void AnalysisResult::getOutgoingEdges(const Data &D,
+                                      GraphEdgeVector &Edges) const {
   size_t Pos = 0;
-  for (ValueInfoSetVector::const_iterator i = Set.begin(), End = Set.end();
+  for (ValueInfoIdSetVector::const_iterator i = Set.begin(), End = Set.end();
        i != End; ++i, ++Pos) {
-    std::ostringstream OSS;
-    OSS << Pos;
-    Result.push_back(GraphEdge(*i, OSS.str()));
+    Edges.push_back(GraphEdge(D.getValueInfo(*i), GraphEdge::ELEMENT, 0, Pos));
+  }
+  if (ContainsUniverse) {
+    Edges.push_back(GraphEdge(D.getUniverse(), GraphEdge::SUBSET, 0, Pos++));
   }
   for (AnalysisResultWorkList::const_iterator i = Work.begin(),
                                               End = Work.end();
        i != End; ++i, ++Pos) {
-    const AnalysisResultWork *Ent = &*i;
-    std::ostringstream OSS;
-    OSS << Pos;
-    Result.push_back(GraphEdge(Ent, OSS.str()));
+    // Work is not a node of its own, so link straight to its input.
+    Edges.push_back(i->toGraphEdge(D, Pos));
   }
-  return Result;
 }
 
 void AnalysisResult::printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const {
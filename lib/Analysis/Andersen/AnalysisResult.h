@@ -16,10 +16,13 @@
 
 #include "AnalysisResultWork.h"
 #include "GraphNode.h"
-#include "SubsetWork.h"
-#include "TransformWorkBase.h"
+#include "IdSetVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
-#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <vector>
 
 namespace llvm {
 
@@ -30,54 +33,132 @@ class raw_ostream;
 namespace llvm {
 namespace andersen_internal {
 
+class Data;
 class DebugInfo;
 class EnumerationResult;
+class EnumerationSession;
+class FinishedSet;
 class ValueInfo;
-typedef SetVector<ValueInfo *> ValueInfoSetVector;
+// The ids of the ValueInfos in a set, in the order they were added.
+typedef IdSetVector<std::vector<uint32_t>, 16> ValueInfoIdSetVector;
 
 class AnalysisResult : public GraphNode {
+  friend class Data;
   friend class EnumerationContext;
   friend class ScopedSetEnumerating;
 
   int EnumerationDepth;
-  ValueInfoSetVector Set;
+  // Dense id, unique within the owning Data. Assigned by Data.
+  uint32_t Id;
+  // The Data this AR belongs to. Assigned by Data along with the id.
+  Data *Owner;
+  ValueInfoIdSetVector Set;
   AnalysisResultWorkList Work;
-  typedef DenseSet<AnalysisResult *> AnalysisResultSet;
-  AnalysisResultSet Subsets;
+  // Ids of the subsets ever added to the work list, or since the last rewrite.
+  // Almost all ARs have at most four, which are found by a linear scan without
+  // any heap allocation.
+  typedef IdSetVector<SmallVector<uint32_t, 4>, 4> AnalysisResultIdSet;
+  AnalysisResultIdSet Subsets;
+  // Compact copy of Set for intersection tests, built on demand once done.
+  FinishedSet *Finished;
+  uint32_t AliasClass;
+  uint32_t UnificationClass;
+  // Whether this set also holds all of the universe of its Data, the points-to
+  // set of ExternallyAccessibleRegions, which is then not copied into Set.
+  bool ContainsUniverse;
 
 public:
+  static const uint32_t NoAliasClass = ~uint32_t(0);
+  static const uint32_t NoUnificationClass = ~uint32_t(0);
+
   AnalysisResult();
   virtual ~AnalysisResult();
 
-  bool addValueInfo(ValueInfo *VI);
-  // Prepare for possibly adding "Subset" to the work list as a
-  // SubsetWork. Returns true if it should be added, else false.
+  uint32_t getId() const { return Id; }
+
+  Data &getOwner() const { return *Owner; }
+
+  bool addValueInfo(const ValueInfo *VI);
+  // Prepare for possibly adding "Subset" to the work list as a subset.
+  // Returns true if it should be added, else false.
   bool prepareForSubset(AnalysisResult *Subset);
-  EnumerationResult enumerate(int Depth, int LastTransformDepth, size_t &i);
+  EnumerationResult enumerate(Data &D, int Depth, int LastTransformDepth,
+                              uint32_t &i, EnumerationSession *Session);
   void writeEquation(const DebugInfo &DI, raw_ostream &OS) const;
 
-  // INSTRUCTION_ANALYSIS_PHASE only.
+  // INSTRUCTION_ANALYSIS_PHASE only, or while the AR is built from relations.
   void appendSubset(AnalysisResult *Entry) {
     if (prepareForSubset(Entry)) {
-      Work.push_back(new SubsetWork(Entry));
+      Work.push_back(AnalysisResultWork::makeSubset(Entry));
     }
   }
 
   // INSTRUCTION_ANALYSIS_PHASE only.
-  void appendUniqueTransform(TransformWorkBase *Entry) {
-    Work.push_back(Entry);
+  void appendUniqueTransform(Data &D, const TransformAlgorithm *Transform,
+                             AnalysisResult *Input) {
+    Work.push_back(AnalysisResultWork::makeTransform(D, Transform, Input));
   }
 
-  const ValueInfoSetVector &getSetContentsSoFar() const { return Set; }
+  // The ids of the elements computed so far, in the order they were found,
+  // except for those only held through the universe.
+  const ValueInfoIdSetVector &getSetContentsSoFar() const { return Set; }
+
+  // Whether this set holds the universe. Only final once done.
+  bool containsUniverse() const { return ContainsUniverse; }
+
+  // Hold the universe of D, the owner of this AR, because Source does. Does
+  // nothing for the universe itself.
+  void addUniverse(Data &D, const AnalysisResult *Source);
+
+  // Whether the element with the given id is known to be in this set, held
+  // explicitly or through the universe of D.
+  bool countSoFar(const Data &D, uint32_t VI) const;
 
   bool isDone() const { return Work.empty(); }
 
-  virtual GraphEdgeDeque getOutgoingEdges() const;
+  // If this AR is nothing but the whole of another AR so far, return that one.
+  AnalysisResult *getWholeSubset() const;
+
+  // Only valid once done. NumValueInfos bounds the ids of the elements. If
+  // Universe is given and this set contains all of it, the result represents it
+  // implicitly. Universe must be given, and done, if this set holds it. The
+  // first call determines the result.
+  const FinishedSet &getFinishedSet(uint32_t NumValueInfos,
+                                    const FinishedSet *Universe = 0);
+
+  // The class of equal sets this belongs to, if assigned by AliasClasses.
+  uint32_t getAliasClass() const { return AliasClass; }
+
+  void setAliasClass(uint32_t Class) { AliasClass = Class; }
+
+  // The class of regions this points-to set is confined to, if assigned by
+  // Unification. Sets of different classes have no element in common.
+  uint32_t getUnificationClass() const { return UnificationClass; }
+
+  void setUnificationClass(uint32_t Class) { UnificationClass = Class; }
+
+  // Add the inputs of all pending work to Inputs.
+  void collectInputs(DenseSet<AnalysisResult *> &Inputs) const;
+
+  // Discard the contents of this done AR and start over with the work of Fresh,
+  // a newly computed AR for the same ValueInfo and algorithm, which is deleted.
+  // Nothing may hold a position in this AR. D is the owner of both.
+  void reset(Data &D, AnalysisResult *Fresh);
+
+  // Change each element id i to NewIds[i]. Must not be called during an
+  // enumeration or once the set is finished.
+  void renumberElements(const std::vector<uint32_t> &NewIds);
+
+  virtual void getOutgoingEdges(const Data &D, GraphEdgeVector &Edges) const;
   virtual void printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const;
   virtual bool isNodeHidden() const;
 
 private:
   bool isEnumerating() const { return EnumerationDepth >= 0; }
+
+  // Add the ValueInfo with the given id, and count it in D, the owner of this
+  // AR. Returns false if already present.
+  bool addId(Data &D, uint32_t VI);
 };
 
 }
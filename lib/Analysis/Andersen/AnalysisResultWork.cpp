@@ -11,17 +11,271 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "andersen"
 #include "AnalysisResultWork.h"
 
+#include "AlgorithmId.h"
+#include "AnalysisResult.h"
+#include "CostAttribution.h"
+#include "Data.h"
+#include "DebugInfo.h"
+#include "Derivations.h"
+#include "EnumerationContext.h"
+#include "EnumerationResult.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
 namespace llvm {
 namespace andersen_internal {
 
-AnalysisResultWork::AnalysisResultWork() {}
+namespace {
+
+// Push the subset for the elements that Input, which holds the universe, has
+// through it: the results of Transform over the universe. Returns false if it
+// is a subset already.
+bool pushUniverseTransform(EnumerationContext *Ctx,
+                           const TransformAlgorithm *Transform,
+                           AnalysisResult *Input) {
+  AnalysisResult *AR = Ctx->getData().getUniverseTransform(Transform);
+  if (!Ctx->pushSubset(AR)) {
+    return false;
+  }
+  if (Derivations *Derivs = Derivations::getActive()) {
+    Derivs->addTransform(Ctx->getAnalysisResult(), AR, Transform->Id, Input, 0);
+  }
+  if (CostAttribution *C = CostAttribution::getActive()) {
+    C->addTransform(Ctx->getAnalysisResult(), Input, AR);
+  }
+  return true;
+}
+
+}
+
+AnalysisResultWork AnalysisResultWork::makeTransform(Data &D,
+    const TransformAlgorithm *Transform, AnalysisResult *AR) {
+  return AnalysisResultWork(AR, D.getTransformIndex(Transform) + 1);
+}
+
+const TransformAlgorithm *AnalysisResultWork::getTransform(const Data &D)
+    const {
+  assert(TransformIndex);
+  return D.getTransform(TransformIndex - 1);
+}
+
+EnumerationResult AnalysisResultWork::enumerate(EnumerationContext *Ctx) {
+  switch (Ctx->getCurrentWork().getKind()) {
+  case SUBSET:
+    return enumerateSubset(Ctx);
+
+  case TRANSFORM:
+    return enumerateTransform(Ctx);
+
+  default:
+    llvm_unreachable("Not a recognized AnalysisResultWork kind");
+    break;
+  }
+}
+
+EnumerationResult AnalysisResultWork::enumerateSubset(
+    EnumerationContext *Ctx) {
+  Data &D = Ctx->getData();
+  if (Ctx->getCurrentWork().getInput() == D.getUniverse()) {
+    // Hold the universe by its flag instead of copying its elements.
+    Ctx->getAnalysisResult()->addUniverse(D, D.getUniverse());
+    return EnumerationResult::makeCompleteResult();
+  }
+  if (Ctx->canInline()) {
+    Enumerator InlineE(Ctx->getCurrentWork().getEnumerator());
+    DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+                 << " In " << Ctx->getAnalysisResult() << ": inlining "
+                 << InlineE.getAnalysisResult() << '['
+                 << InlineE.getPosition() << ":]\n");
+    return EnumerationResult::makeInlineResult(InlineE);
+  }
+  DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+               << " In " << Ctx->getAnalysisResult() << ": recurse to "
+               << Ctx->getCurrentWork().getInput() << '['
+               << Ctx->getCurrentWork().Position << "]\n");
+  for (;;) {
+    // Enumerate a copy, since the work list may be reallocated meanwhile.
+    Enumerator E(Ctx->getCurrentWork().getEnumerator());
+    EnumerationResult ER(E.enumerate(D, Ctx->getNextDepth(),
+                                     Ctx->getLastTransformDepth(),
+                                     Ctx->getSession()));
+    // The subset may have come to hold the universe meanwhile. Take it before
+    // an inline skips past the subset to its own subset.
+    if (E.getAnalysisResult()->containsUniverse()) {
+      Ctx->getAnalysisResult()->addUniverse(D, E.getAnalysisResult());
+    }
+    if (ER.getResultType() != EnumerationResult::INLINE) {
+      Ctx->getCurrentWork().setEnumerator(E);
+      return ER;
+    }
 
-AnalysisResultWork::~AnalysisResultWork() {}
+    Enumerator NewE(ER.getInlineEnumerator());
+    if (!Ctx->getAnalysisResult()->prepareForSubset(NewE.getAnalysisResult())) {
+      DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+                   << " In " << Ctx->getAnalysisResult()
+                   << ": optimized away inline of " << NewE.getAnalysisResult()
+                   << '[' << NewE.getPosition() << ":]\n");
+      return EnumerationResult::makeCompleteResult();
+    }
+    if (NewE.getAnalysisResult() == D.getUniverse()) {
+      DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+                   << " In " << Ctx->getAnalysisResult()
+                   << ": holding the universe instead of inlining it\n");
+      Ctx->getAnalysisResult()->addUniverse(D, D.getUniverse());
+      return EnumerationResult::makeCompleteResult();
+    }
+    if (Derivations *Derivs = Derivations::getActive()) {
+      Derivs->moveSubset(Ctx->getAnalysisResult(),
+                         Ctx->getCurrentWork().getInput(),
+                         Ctx->getAnalysisResult(), NewE.getAnalysisResult());
+    }
+    if (CostAttribution *C = CostAttribution::getActive()) {
+      C->moveSubset(Ctx->getAnalysisResult(), Ctx->getCurrentWork().getInput(),
+                    Ctx->getAnalysisResult(), NewE.getAnalysisResult());
+    }
+    Ctx->getCurrentWork().setEnumerator(NewE);
+    DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+                 << " In " << Ctx->getAnalysisResult() << ": inlined "
+                 << NewE.getAnalysisResult() << '[' << NewE.getPosition()
+                 << ":]\n");
+  }
+}
+
+EnumerationResult AnalysisResultWork::enumerateTransform(
+    EnumerationContext *Ctx) {
+  for (;;) {
+    // Enumerate a copy, since the work list may be reallocated meanwhile.
+    Enumerator E(Ctx->getCurrentWork().getEnumerator());
+    DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+                 << " In " << Ctx->getAnalysisResult() << ": transform "
+                 << E.getAnalysisResult() << '[' << E.getPosition() << "]\n");
+    EnumerationResult ER(E.enumerate(Ctx->getData(), Ctx->getNextDepth(),
+                                     Ctx->getDepth(), Ctx->getSession()));
+    AnalysisResult *Input = E.getAnalysisResult();
+    switch (ER.getResultType()) {
+    case EnumerationResult::NEXT_VALUE: {
+      // Also consume the input elements that are already cached, so that their
+      // subsets are scheduled in one batch rather than one per round trip
+      // through the input.
+      uint32_t First = E.getPosition() - 1;
+      uint32_t End = Input->getSetContentsSoFar().size();
+      AnalysisResultWork &Work = Ctx->getCurrentWork();
+      Work.setEnumerator(Enumerator(Input, End));
+      Data &D = Ctx->getData();
+      const TransformAlgorithm *Transform = Work.getTransform(D);
+      SmallVector<AnalysisResult *, 8> Batch;
+      for (uint32_t i = First; i != End; ++i) {
+        // Index every time, since analysis may grow the input.
+        uint32_t Id = i == First ? ER.getNextValue()
+                                 : Input->getSetContentsSoFar()[i];
+        ValueInfo *VI = D.getValueInfo(Id);
+        AnalysisResult *AR = (*Transform->AnalyzeValueInfo)(VI);
+        DEBUG(dbgs() << Ctx->getDepth() << ':' << Ctx->getLastTransformDepth()
+                     << " In " << Ctx->getAnalysisResult() << ": transformed "
+                     << Input << '[' << i << "] to ");
+        if (!AR) {
+          DEBUG(dbgs() << "empty set\n");
+          continue;
+        }
+        DEBUG(dbgs() << AR << '\n');
+        if (Derivations *Derivs = Derivations::getActive()) {
+          Derivs->addTransform(Ctx->getAnalysisResult(), AR, Transform->Id,
+                               Input, VI);
+        }
+        if (CostAttribution *C = CostAttribution::getActive()) {
+          C->addTransform(Ctx->getAnalysisResult(), Input, AR);
+        }
+        Batch.push_back(AR);
+      }
+      // The results over the universe, if the input holds it, run last.
+      bool Pushed = Input->containsUniverse() &&
+                    pushUniverseTransform(Ctx, Transform, Input);
+      // Insert in reverse so that the subsets run in the order of the input.
+      for (SmallVectorImpl<AnalysisResult *>::const_reverse_iterator
+               i = Batch.rbegin(), BatchEnd = Batch.rend();
+           i != BatchEnd; ++i) {
+        Pushed |= Ctx->pushSubset(*i);
+      }
+      if (!Pushed) continue;
+      // The current work is now the first new subset.
+      return enumerateSubset(Ctx);
+    }
+
+    case EnumerationResult::INLINE:
+      llvm_unreachable("Cannot inline past a transform");
+      break;
+
+    case EnumerationResult::RETRY:
+    case EnumerationResult::COMPLETE:
+      Ctx->getCurrentWork().setEnumerator(E);
+      // The input may have come to hold the universe after its last element.
+      if (Input->containsUniverse() &&
+          pushUniverseTransform(
+              Ctx, Ctx->getCurrentWork().getTransform(Ctx->getData()),
+              Input)) {
+        return enumerateSubset(Ctx);
+      }
+      break;
+
+    case EnumerationResult::SUSPEND:
+      Ctx->getCurrentWork().setEnumerator(E);
+      break;
+
+    case EnumerationResult::REWRITE:
+      llvm_unreachable("Cannot rewrite past a transform");
+      break;
+
+    default:
+      llvm_unreachable("Not a recognized EnumerationResult");
+      break;
+    }
+    return ER;
+  }
+}
+
+bool AnalysisResultWork::prepareForRewrite(AnalysisResult *RewriteTarget)
+    const {
+  switch (getKind()) {
+  case SUBSET:
+    // If the target doesn't want this subset then delete it instead of moving
+    // it.
+    return RewriteTarget->prepareForSubset(getInput());
+
+  case TRANSFORM:
+    // Redundant transforms in the same AnalysisResult are not possible since
+    // each distinct transform step is only ever created once, so we always
+    // move the transforms.
+    return true;
+
+  default:
+    llvm_unreachable("Not a recognized AnalysisResultWork kind");
+    break;
+  }
+}
+
+void AnalysisResultWork::writeFormula(const DebugInfo &DI, raw_ostream &OS)
+    const {
+  if (getKind() == SUBSET) {
+    getEnumerator().writeFormula(DI, OS);
+    return;
+  }
+  getTransform(*DI.getData())->Id->printAlgorithmName(OS);
+  OS << '(';
+  getEnumerator().writeFormula(DI, OS);
+  OS << ')';
+}
 
-bool AnalysisResultWork::isNodeHidden() const {
-  return false;
+GraphEdge AnalysisResultWork::toGraphEdge(const Data &D, size_t Pos) const {
+  if (getKind() == SUBSET) {
+    return GraphEdge(getInput(), GraphEdge::SUBSET, 0, Pos, Position);
+  }
+  return GraphEdge(getInput(), GraphEdge::TRANSFORM, getTransform(D)->Id, Pos,
+                   Position);
 }
 
 }
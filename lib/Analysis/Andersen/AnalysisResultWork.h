@@ -14,9 +14,12 @@
 #ifndef ANALYSISRESULTWORK_H
 #define ANALYSISRESULTWORK_H
 
+#include "Enumerator.h"
 #include "GraphNode.h"
-#include "llvm/ADT/ilist.h"
-#include "llvm/ADT/ilist_node.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <cstddef>
+#include <vector>
 
 namespace llvm {
 
@@ -27,38 +30,91 @@ class raw_ostream;
 namespace llvm {
 namespace andersen_internal {
 
+class AlgorithmId;
 class AnalysisResult;
+class Data;
 class DebugInfo;
 class EnumerationContext;
 class EnumerationResult;
+class ValueInfo;
+
+// A ValueInfo-to-AnalysisResult function for transforms to apply to the
+// elements of their input. There is one of these per algorithm (see
+// TransformWork).
+struct TransformAlgorithm {
+  const AlgorithmId *Id;
+  AnalysisResult *(*AnalyzeValueInfo)(ValueInfo *);
+};
+
+// One item of pending work, stored by value in its AnalysisResult's work list.
+// It is either a subset, which enumerates the elements of its input, or a
+// transform, which computes the list comprehension of a TransformAlgorithm run
+// on the elements of its input. The enumerator is stored unpacked and the
+// transform as a 32-bit index so that an item takes two words.
+class AnalysisResultWork {
+  AnalysisResult *Input;
+  uint32_t Position;
+  // 0 for subsets, else one more than the index of the TransformAlgorithm in
+  // the table of the owning Data.
+  uint32_t TransformIndex;
+
+  AnalysisResultWork(AnalysisResult *AR, uint32_t TransformIndex)
+    : Input(AR), Position(0), TransformIndex(TransformIndex) {}
+
+  Enumerator getEnumerator() const { return Enumerator(Input, Position); }
+
+  void setEnumerator(const Enumerator &E) {
+    Input = E.getAnalysisResult();
+    Position = E.getPosition();
+  }
 
-class AnalysisResultWork :
-    public ilist_node<AnalysisResultWork>,
-    public GraphNode {
 public:
-  AnalysisResultWork();
-  virtual ~AnalysisResultWork();
-  virtual bool isNodeHidden() const;
+  enum Kind {
+    SUBSET,
+    TRANSFORM
+  };
 
-  virtual EnumerationResult enumerate(EnumerationContext *Ctx) = 0;
-  virtual bool prepareForRewrite(AnalysisResult *RewriteTarget) const = 0;
-  virtual void writeFormula(const DebugInfo &DI, raw_ostream &OS) const = 0;
-};
+  static AnalysisResultWork makeSubset(AnalysisResult *AR) {
+    return AnalysisResultWork(AR, 0);
+  }
 
-typedef iplist<AnalysisResultWork> AnalysisResultWorkList;
+  static AnalysisResultWork makeTransform(Data &D,
+                                          const TransformAlgorithm *Transform,
+                                          AnalysisResult *AR);
 
-}
-}
+  Kind getKind() const { return TransformIndex ? TRANSFORM : SUBSET; }
 
-namespace llvm {
+  // Only valid for transforms. D is the Data the work belongs to.
+  const TransformAlgorithm *getTransform(const Data &D) const;
+
+  // The AR this work reads from.
+  AnalysisResult *getInput() const { return Input; }
+
+  // The index in the input of the next element to read.
+  uint32_t getPosition() const { return Position; }
+
+  // Read from NewInput instead, at the same position.
+  void setInput(AnalysisResult *NewInput) { Input = NewInput; }
+
+  // Enumerate the work at the current position of Ctx. This cannot be a member
+  // function because nested enumeration may grow other work lists, including
+  // the one holding this work, so the work is only accessed through Ctx.
+  static EnumerationResult enumerate(EnumerationContext *Ctx);
 
-template<>
-struct ilist_traits<andersen_internal::AnalysisResultWork>
-  : public ilist_nextprev_traits<andersen_internal::AnalysisResultWork>,
-    public ilist_ghostly_sentinel_traits<
-        andersen_internal::AnalysisResultWork>,
-    public ilist_node_traits<andersen_internal::AnalysisResultWork> {};
+  bool prepareForRewrite(AnalysisResult *RewriteTarget) const;
+  void writeFormula(const DebugInfo &DI, raw_ostream &OS) const;
+  // Edge to the input for graph output. Pos is the position of this work in its
+  // AR's combined list of set elements and work.
+  GraphEdge toGraphEdge(const Data &D, size_t Pos) const;
 
+private:
+  static EnumerationResult enumerateSubset(EnumerationContext *Ctx);
+  static EnumerationResult enumerateTransform(EnumerationContext *Ctx);
+};
+
+typedef std::vector<AnalysisResultWork> AnalysisResultWorkList;
+
+}
 }
 
 #endif
@@ -21,6 +21,7 @@ using namespace llvm;
 /// initializeAndersen - Initialize all passes linked into the Andersen library.
 void llvm::initializeAndersen(PassRegistry &Registry) {
   initializeAndersenAliasAnalysisPass(Registry);
+  initializeAndersenExplainPrinterPass(Registry);
   initializeAndersenGraphPrinterPass(Registry);
   initializeAndersenGraphViewerPass(Registry);
   initializeAndersenPassPass(Registry);
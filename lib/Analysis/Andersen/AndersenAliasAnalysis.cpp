@@ -12,8 +12,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "andersen-aa"
+#include "EnumerationSession.h"
 #include "ValueInfo.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AndersenEnumerator.h"
 #include "llvm/Analysis/AndersenPass.h"
@@ -21,6 +25,7 @@
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Pass.h"
 
 #include <cassert>
@@ -30,6 +35,36 @@ namespace {
 
 using namespace andersen_internal;
 
+STATISTIC(NumOutOfBudget, "Number of queries that ran out of budget");
+
+// Whether VI is known to be a constant region, or a local one if OrLocal.
+bool isConstantOrLocal(const ValueInfo *VI, bool OrLocal) {
+  const Value *V = VI->getValue();
+  if (!V) {
+    // External regions can't be guaranteed to be either const or local.
+    // TODO: We can do better for overridable GlobalVariables if we introduce
+    // a special VI for externally linkable constant regions, since it isn't
+    // legal for a global to be marked constant in some modules and
+    // non-constant in others
+    return false;
+  }
+
+  if (OrLocal && isa<AllocaInst>(V)) {
+    return true;
+  }
+
+  if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(V)) {
+    return GV->isConstant();
+  }
+
+  return false;
+}
+
+cl::opt<unsigned> QueryBudget("andersen-query-budget",
+    cl::desc("Maximum units of enumeration work per alias query before "
+             "falling back to the next alias analysis (0 = unlimited)"),
+    cl::init(0));
+
 /// AndersenAliasAnalysis - An alias analysis implementation that uses
 /// AndersenPass queries.
 class AndersenAliasAnalysis : public ModulePass, public AliasAnalysis {
@@ -84,57 +119,60 @@ bool AndersenAliasAnalysis::runOnModule(Module &M) {
 AliasAnalysis::AliasResult
 AndersenAliasAnalysis::alias(const Location &LocA,
                              const Location &LocB) {
-  AndersenHandle A = AP->getHandleToPointsToSet(LocA.Ptr);
-  AndersenHandle B = AP->getHandleToPointsToSet(LocB.Ptr);
-  if (AP->isPointsToSetEmpty(A) || AP->isPointsToSetEmpty(B)) {
-    // If either points to nothing, then we can skip the rest.
-    return NoAlias;
+  AndersenHandle A, B;
+  if (!AP->getHandleToPointsToSet(LocA.Ptr, A) ||
+      !AP->getHandleToPointsToSet(LocB.Ptr, B)) {
+    // Not analyzed as it is now.
+    return AliasAnalysis::alias(LocA, LocB);
   }
-  // TODO: What is the optimal enumeration strategy?
-  const PointsToSet *PointsToSetA = AP->getPointsToSet(A);
-  assert(PointsToSetA);
-  for (AndersenEnumerator AE(AP->enumeratePointsToSet(B));; ) {
-    ValueInfo *Next = AE.enumerate();
-    if (!Next) break;
-    if (PointsToSetA->count(Next)) {
-      // TODO: We may be able to eliminate some MayAlias results by calling
-      // through to the base AA with the Value(s) related to A and B's
-      // dependency on Next.
-      return AliasAnalysis::alias(LocA, LocB);
-    }
+  bool Intersect;
+  if (!QueryBudget) {
+    Intersect = AP->doPointsToSetsIntersect(A, B);
+  } else if (!AP->tryPointsToSetsIntersect(A, B, QueryBudget, Intersect)) {
+    // Too expensive to answer now. The progress made is kept for later
+    // queries.
+    ++NumOutOfBudget;
+    return AliasAnalysis::alias(LocA, LocB);
+  }
+  if (!Intersect) {
+    // No overlap in the points-to sets, so cannot alias.
+    return NoAlias;
   }
-  // No overlap in the points-to sets, so cannot alias.
-  return NoAlias;
+  // TODO: We may be able to eliminate some MayAlias results by calling through
+  // to the base AA with the Value(s) related to A and B's dependency on the
+  // common elements.
+  return AliasAnalysis::alias(LocA, LocB);
 }
 
 bool AndersenAliasAnalysis::pointsToConstantMemory(const Location &Loc,
                                                    bool OrLocal) {
-  AndersenHandle L = AP->getHandleToPointsToSet(Loc.Ptr);
+  AndersenHandle L;
+  if (!AP->getHandleToPointsToSet(Loc.Ptr, L)) {
+    return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
+  }
+  EnumerationSession Budgeted(QueryBudget);
+  EnumerationSession *Session = QueryBudget ? &Budgeted : 0;
   // This is loosely based on the BasicAliasAnalysis implementation.
+  SmallVector<ValueInfo *, 16> Batch;
   for (AndersenEnumerator AE(AP->enumeratePointsToSet(L));; ) {
-    ValueInfo *Next = AE.enumerate();
-    if (!Next) break;
-    const Value *V = Next->getValue();
-    if (!V) {
-      // External regions can't be guaranteed to be either const or local.
-      // TODO: We can do better for overridable GlobalVariables if we introduce
-      // a special VI for externally linkable constant regions, since it isn't
-      // legal for a global to be marked constant in some modules and
-      // non-constant in others
-      return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
-    }
-
-    if (OrLocal && isa<AllocaInst>(V)) {
-      continue;
+    Batch.clear();
+    // Take all cached elements at once, but compute new ones one at a time,
+    // since the first region that disqualifies the set ends the scan.
+    bool More = AE.enumerate(Batch, 1, Session);
+    for (SmallVectorImpl<ValueInfo *>::const_iterator i = Batch.begin(),
+                                                      End = Batch.end();
+         i != End; ++i) {
+      if (!isConstantOrLocal(*i, OrLocal)) {
+        return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
+      }
     }
-
-    if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(V)) {
-      if (GV->isConstant()) {
-        continue;
+    if (!More) {
+      if (Session && Session->isSuspended()) {
+        ++NumOutOfBudget;
+        return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
       }
+      break;
     }
-
-    return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
   }
   return true;
 }
@@ -16,7 +16,10 @@
 #include "llvm/Analysis/AndersenEnumerator.h"
 
 #include "AnalysisResult.h"
+#include "BackgroundSolver.h"
+#include "Data.h"
 #include "EnumerationResult.h"
+#include "EnumerationSession.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -27,13 +30,18 @@ namespace llvm {
 
 using namespace andersen_internal;
 
-ValueInfo *AndersenEnumerator::enumerate() {
+namespace {
+
+// Get the next element of AR from position i, or null at the end of AR or if
+// Session runs out of budget.
+ValueInfo *enumerateFrom(Data *D, AnalysisResult *AR, uint32_t &i,
+                         EnumerationSession *Session) {
   DEBUG(dbgs() << "Begin " << AR << '[' << i << "]\n");
-  EnumerationResult ER(AR->enumerate(0, -1, i));
+  EnumerationResult ER(AR->enumerate(*D, 0, -1, i, Session));
   switch (ER.getResultType()) {
   case EnumerationResult::NEXT_VALUE:
     DEBUG(dbgs() << "Result: " << ER.getNextValue() << '\n'); 
-    return ER.getNextValue();
+    return D->getValueInfo(ER.getNextValue());
 
   case EnumerationResult::INLINE:
     llvm_unreachable("Received spurious inline-result");
@@ -51,6 +59,11 @@ ValueInfo *AndersenEnumerator::enumerate() {
     DEBUG(dbgs() << "Result: end of set\n"); 
     break;
 
+  case EnumerationResult::SUSPEND:
+    assert(Session && Session->isSuspended());
+    DEBUG(dbgs() << "Result: out of budget\n");
+    break;
+
   default:
     llvm_unreachable("Not a recognized EnumerationResult");
     break;
@@ -58,4 +71,84 @@ ValueInfo *AndersenEnumerator::enumerate() {
   return 0;
 }
 
+// Get the next element of AR from position i, then of the universe from
+// position j if AR holds it. The caller must hold a BackgroundSolver::Guard.
+ValueInfo *enumerateNext(Data *D, AnalysisResult *AR, uint32_t &i, uint32_t &j,
+                         EnumerationSession *Session) {
+  const ValueInfoIdSetVector &Set = AR->getSetContentsSoFar();
+  if (i < Set.size() || !AR->isDone()) {
+    if (ValueInfo *VI = enumerateFrom(D, AR, i, Session)) {
+      return VI;
+    }
+  }
+  if (!AR->isDone() || !AR->containsUniverse()) {
+    // The end of the set, or out of budget.
+    return 0;
+  }
+  // AR is done, so the elements it lists are final, and those of the universe
+  // among them are skipped.
+  while (ValueInfo *VI = enumerateFrom(D, D->getUniverse(), j, Session)) {
+    if (!Set.count(VI->getId())) {
+      return VI;
+    }
+  }
+  return 0;
+}
+
+}
+
+ValueInfo *AndersenEnumerator::enumerate() {
+  return enumerate(0);
+}
+
+ValueInfo *AndersenEnumerator::enumerate(EnumerationSession *Session) {
+  Data *D = &AR->getOwner();
+  BackgroundSolver::Guard G(D);
+  return enumerateNext(D, AR, i, j, Session);
+}
+
+bool AndersenEnumerator::enumerate(SmallVectorImpl<ValueInfo *> &Out,
+                                   size_t Max) {
+  return enumerate(Out, Max, 0);
+}
+
+bool AndersenEnumerator::enumerate(SmallVectorImpl<ValueInfo *> &Out,
+                                   size_t Max, EnumerationSession *Session) {
+  Data *D = &AR->getOwner();
+  BackgroundSolver::Guard G(D);
+  // Copy the cached elements directly instead of entering the AR for each.
+  const ValueInfoIdSetVector &Set = AR->getSetContentsSoFar();
+  if (i < Set.size()) {
+    DEBUG(dbgs() << "Begin " << AR << '[' << i << "]: " << (Set.size() - i)
+                 << " cached\n");
+    Out.reserve(Out.size() + (Set.size() - i));
+    for (uint32_t End = Set.size(); i != End; ++i) {
+      Out.push_back(D->getValueInfo(Set[i]));
+    }
+  }
+  if (AR->isDone()) {
+    if (!AR->containsUniverse()) {
+      return false;
+    }
+    AnalysisResult *Universe = D->getUniverse();
+    const ValueInfoIdSetVector &UniverseSet = Universe->getSetContentsSoFar();
+    for (uint32_t End = UniverseSet.size(); j < End; ++j) {
+      if (!Set.count(UniverseSet[j])) {
+        Out.push_back(D->getValueInfo(UniverseSet[j]));
+      }
+    }
+    if (Universe->isDone()) {
+      return false;
+    }
+  }
+  for (size_t n = 0; n != Max; ++n) {
+    ValueInfo *VI = enumerateNext(D, AR, i, j, Session);
+    if (!VI) {
+      return false;
+    }
+    Out.push_back(VI);
+  }
+  return true;
+}
+
 }
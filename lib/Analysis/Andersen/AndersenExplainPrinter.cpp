@@ -0,0 +1,98 @@
+//===- AndersenExplainPrinter.cpp - explain set membership ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a pass that prints why points-to sets computed by
+// AndersenPass contain given regions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BackgroundSolver.h"
+#include "Data.h"
+#include "Phase.h"
+#include "PointsToAlgorithm.h"
+#include "ValueInfo.h"
+#include "llvm/Analysis/AndersenPass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+namespace llvm {
+
+using namespace andersen_internal;
+
+namespace {
+
+cl::opt<std::string> ExplainSet("andersen-explain-set",
+    cl::desc("The value whose points-to set -explain-andersen explains, named "
+             "as in constraint files"),
+    cl::value_desc("name"));
+
+cl::list<std::string> ExplainElements("andersen-explain-element",
+    cl::desc("A region to explain the membership of in the set given with "
+             "-andersen-explain-set, named as in constraint files"),
+    cl::value_desc("name"));
+
+}
+
+class AndersenExplainPrinter : public ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+
+  AndersenExplainPrinter() : ModulePass(ID) {
+    initializeAndersenExplainPrinterPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual bool runOnModule(Module &M) {
+    const AndersenPass &AP = getAnalysis<AndersenPass>();
+    const Data *D = AP.Data;
+    BackgroundSolver::Guard G(D);
+    ValueInfo *SetVI = D->findValueInfo(M, ExplainSet);
+    if (!SetVI) {
+      errs() << "No value named '" << ExplainSet << "' to explain\n";
+      return false;
+    }
+    AndersenHandle AH =
+        SetVI->getAlgorithmResult<PointsToAlgorithm, ENUMERATION_PHASE>();
+    for (cl::list<std::string>::const_iterator i = ExplainElements.begin(),
+                                               End = ExplainElements.end();
+         i != End; ++i) {
+      ValueInfo *VI = D->findValueInfo(M, *i);
+      if (!VI) {
+        errs() << "No value named '" << *i << "' to explain\n";
+        continue;
+      }
+      outs() << "Why " << *i << " is in the points-to set of " << ExplainSet
+             << ":\n";
+      AP.explainMembership(AH, VI, outs());
+    }
+    return false;
+  }
+
+  virtual void print(raw_ostream &OS, const Module* = 0) const {}
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<AndersenPass>();
+  }
+};
+
+char AndersenExplainPrinter::ID = 0;
+
+}
+
+using namespace llvm;
+
+INITIALIZE_PASS_BEGIN(AndersenExplainPrinter, "explain-andersen",
+                      "Explain Andersen points-to set membership", false, true)
+INITIALIZE_PASS_DEPENDENCY(AndersenPass)
+INITIALIZE_PASS_END(AndersenExplainPrinter, "explain-andersen",
+                    "Explain Andersen points-to set membership", false, true)
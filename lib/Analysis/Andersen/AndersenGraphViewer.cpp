@@ -12,18 +12,24 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "AlgorithmId.h"
+#include "BackgroundSolver.h"
 #include "Data.h"
 #include "DebugInfo.h"
 #include "GraphNode.h"
-#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/AndersenPass.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/GraphWriter.h"
-#include "llvm/Support/raw_os_ostream.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/raw_ostream.h"
 
-#include <sstream>
 #include <string>
+#include <vector>
 
 namespace llvm {
 
@@ -31,111 +37,261 @@ using namespace andersen_internal;
 
 namespace {
 
-class NodeForwardIterator {
-  GraphEdgeDeque RemainingEdges;
+cl::list<std::string> GraphValues("andersen-graph-value",
+    cl::desc("Only output the part of the graph near the given value, named "
+             "as in constraint files (@g, @f:%x or @f:#N)"),
+    cl::value_desc("name"));
 
-public:
-  typedef ssize_t difference_type;
-  typedef const GraphNode *value_type;
-  typedef value_type *pointer;
-  typedef value_type &reference;
-  typedef std::forward_iterator_tag iterator_category;
+cl::list<std::string> GraphFunctions("andersen-graph-function",
+    cl::desc("Only output the part of the graph near the arguments and "
+             "instructions of the given function"),
+    cl::value_desc("name"));
 
-  NodeForwardIterator() {}
+cl::list<std::string> GraphResults("andersen-graph-result",
+    cl::desc("Only output the part of the graph near the given analysis "
+             "result, named as Algorithm(value)"),
+    cl::value_desc("name"));
 
-  explicit NodeForwardIterator(const GraphEdgeDeque &Edges)
-    : RemainingEdges(Edges) {}
+cl::opt<unsigned> GraphDepth("andersen-graph-depth",
+    cl::desc("Number of edges to follow from the nodes given with "
+             "-andersen-graph-value, -function or -result"),
+    cl::init(2));
 
-  const std::string &getLabel() const { return RemainingEdges.front().Label; }
+cl::opt<unsigned> GraphMaxSize("andersen-graph-max-size",
+    cl::desc("Approximate size in megabytes at which graph output stops "
+             "(0 = unlimited)"),
+    cl::init(64));
 
-  value_type operator*() const { return RemainingEdges.front().Dst; }
+std::string getGraphTitle(const Module *M) {
+  std::string Title("AndersenPass analysis results");
+  if (M) {
+    Title += " for module " + M->getModuleIdentifier();
+  }
+  return Title;
+}
 
-  bool operator==(const NodeForwardIterator &that) const {
-    // Since it's invalid to compare iterators from different objects, it's
-    // sufficient to compare the size here.
-    return RemainingEdges.size() == that.RemainingEdges.size();
+// Find the AR named by Spec, as printed in node labels. Returns null if it has
+// not been built.
+const GraphNode *findAnalysisResult(const Data *D, const Module &M,
+                                    StringRef Spec) {
+  size_t Open = Spec.find('(');
+  if (Open == StringRef::npos || !Spec.endswith(")")) {
+    return 0;
+  }
+  StringRef Algorithm = Spec.substr(0, Open);
+  const ValueInfo *VI =
+      D->findValueInfo(M, Spec.slice(Open + 1, Spec.size() - 1));
+  if (!VI) {
+    return 0;
   }
+  SmallVector<GraphEdge, 8> Edges;
+  VI->getOutgoingEdges(*D, Edges);
+  for (SmallVectorImpl<GraphEdge>::const_iterator i = Edges.begin(),
+                                                  End = Edges.end();
+       i != End; ++i) {
+    SmallString<64> Name;
+    raw_svector_ostream OS(Name);
+    i->getAlgorithmId()->printAlgorithmName(OS);
+    if (OS.str() == Algorithm) {
+      return i->getDestination();
+    }
+  }
+  return 0;
+}
 
-  bool operator!=(const NodeForwardIterator &that) const {
-    return !(*this == that);
+// Writes the subgraph within a number of edges of some root nodes in DOT
+// format, straight to the stream and in breadth-first order, so that it can
+// stop at any point once the output gets too large.
+class GraphOutput {
+  const DebugInfo DI;
+  raw_ostream &OS;
+  const uint64_t MaxSize;
+  // The nodes output so far, in order, and their distance from the roots.
+  std::vector<const GraphNode *> Nodes;
+  DenseMap<const GraphNode *, unsigned> Depths;
+  bool Truncated;
+
+  bool isFull() {
+    if (MaxSize && OS.tell() >= MaxSize) {
+      Truncated = true;
+    }
+    return Truncated;
   }
 
-  NodeForwardIterator &operator++() {
-    RemainingEdges.pop_front();
-    return *this;
+  void writeNodeName(const GraphNode *Node) {
+    OS << "Node" << static_cast<const void *>(Node);
   }
 
-  NodeForwardIterator operator++(int) {
-    NodeForwardIterator Tmp = *this;
-    ++*this;
-    return Tmp;
+  void writeNode(const GraphNode *Node) {
+    SmallString<128> Label;
+    {
+      raw_svector_ostream LabelOS(Label);
+      Node->printNodeLabel(DI, LabelOS);
+    }
+    OS << '\t';
+    writeNodeName(Node);
+    OS << " [shape=box,label=\"";
+    for (SmallString<128>::const_iterator i = Label.begin(), End = Label.end();
+         i != End; ++i) {
+      if (*i == '"' || *i == '\\') {
+        OS << '\\';
+      }
+      OS << *i;
+    }
+    OS << "\"];\n";
   }
-};
 
-std::string getGraphTitle(const Module *M) {
-  std::ostringstream OSS;
-  OSS << "AndersenPass analysis results";
-  if (M) {
-    OSS << " for module " << M->getModuleIdentifier();
+  void writeEdge(const GraphNode *Src, const GraphEdge &Edge) {
+    OS << '\t';
+    writeNodeName(Src);
+    OS << " -> ";
+    writeNodeName(Edge.getDestination());
+    if (Edge.getLabelKind() != GraphEdge::NONE) {
+      OS << " [label=\"";
+      Edge.printLabel(OS);
+      OS << '"' << ']';
+    }
+    OS << ";\n";
   }
-  return OSS.str();
-}
 
-}
+public:
+  GraphOutput(const Data *D, raw_ostream &OS, uint64_t MaxSize)
+    : DI(D), OS(OS), MaxSize(MaxSize), Truncated(false) {}
 
-template<>
-struct GraphTraits<DebugInfo> {
-  typedef const GraphNode NodeType;
-  typedef df_iterator<DebugInfo> nodes_iterator;
-  typedef NodeForwardIterator ChildIteratorType;
+  bool isTruncated() const { return Truncated; }
 
-  static ChildIteratorType child_begin(NodeType *Node) {
-    return ChildIteratorType(Node->getOutgoingEdges());
+  // Output Node at distance Depth unless it is hidden or already output.
+  // Returns false if it was not output.
+  bool addNode(const GraphNode *Node, unsigned Depth) {
+    if (Node->isNodeHidden() || isFull() ||
+        !Depths.insert(std::make_pair(Node, Depth)).second) {
+      return false;
+    }
+    Nodes.push_back(Node);
+    writeNode(Node);
+    return true;
   }
 
-  static ChildIteratorType child_end(NodeType *Node) {
-    return ChildIteratorType();
+  // Output all nodes and edges within MaxDepth edges of those added so far.
+  void write(unsigned MaxDepth) {
+    SmallVector<GraphEdge, 16> Edges;
+    for (size_t i = 0; i != Nodes.size() && !isFull(); ++i) {
+      const GraphNode *Node = Nodes[i];
+      unsigned Depth = Depths[Node];
+      if (Depth == MaxDepth) {
+        continue;
+      }
+      Edges.clear();
+      Node->getOutgoingEdges(*DI.getData(), Edges);
+      for (SmallVectorImpl<GraphEdge>::const_iterator j = Edges.begin(),
+                                                      End = Edges.end();
+           j != End && !isFull(); ++j) {
+        const GraphNode *Dst = j->getDestination();
+        if (Depths.count(Dst) || addNode(Dst, Depth + 1)) {
+          writeEdge(Node, *j);
+        }
+      }
+    }
   }
+};
 
-  static NodeType *getEntryNode(const DebugInfo &DI) {
-    return DI.getData();
+// Output the part of the graph selected by the options, or all of it.
+void writeGraph(raw_ostream &OS, const Data *D, const Module &M) {
+  std::string Title(getGraphTitle(&M));
+  OS << "digraph \"" << Title << "\" {\n"
+     << "\tlabel=\"" << Title << "\";\n\n";
+  GraphOutput Output(D, OS, uint64_t(GraphMaxSize) << 20);
+  bool HasRoots = false;
+  for (cl::list<std::string>::const_iterator i = GraphValues.begin(),
+                                             End = GraphValues.end();
+       i != End; ++i) {
+    HasRoots = true;
+    if (ValueInfo *VI = D->findValueInfo(M, *i)) {
+      Output.addNode(VI, 0);
+    } else {
+      errs() << "No value named '" << *i << "' for the graph\n";
+    }
   }
-
-  static nodes_iterator nodes_begin(const DebugInfo &DI) {
-    return df_begin(DI);
+  for (cl::list<std::string>::const_iterator i = GraphFunctions.begin(),
+                                             End = GraphFunctions.end();
+       i != End; ++i) {
+    HasRoots = true;
+    const Function *F = M.getFunction(*i);
+    if (!F) {
+      errs() << "No function named '" << *i << "' for the graph\n";
+      continue;
+    }
+    ValueInfo *VI;
+    for (Function::const_arg_iterator A = F->arg_begin(), AEnd = F->arg_end();
+         A != AEnd; ++A) {
+      if (D->lookupValueInfo(A, VI) && VI) {
+        Output.addNode(VI, 0);
+      }
+    }
+    FunctionBodyMap::const_iterator Body =
+        D->DematerializedValueInfos.find(F);
+    if (Body != D->DematerializedValueInfos.end()) {
+      for (ValueInfoVector::const_iterator j = Body->second.begin(),
+                                           JEnd = Body->second.end();
+           j != JEnd; ++j) {
+        if (*j) {
+          Output.addNode(j->getPtr(), 0);
+        }
+      }
+      continue;
+    }
+    for (const_inst_iterator j = inst_begin(F), JEnd = inst_end(F); j != JEnd;
+         ++j) {
+      if (D->lookupValueInfo(&*j, VI) && VI) {
+        Output.addNode(VI, 0);
+      }
+    }
   }
-
-  static nodes_iterator nodes_end(const DebugInfo &DI) {
-    return df_end(DI);
+  for (cl::list<std::string>::const_iterator i = GraphResults.begin(),
+                                             End = GraphResults.end();
+       i != End; ++i) {
+    HasRoots = true;
+    if (const GraphNode *AR = findAnalysisResult(D, M, *i)) {
+      Output.addNode(AR, 0);
+    } else {
+      errs() << "No analysis result named '" << *i << "' for the graph\n";
+    }
   }
-};
-
-template<>
-class DOTGraphTraits<DebugInfo> : public DefaultDOTGraphTraits {
-public:
-  DOTGraphTraits(bool simple = false) : DefaultDOTGraphTraits(simple) {}
-
-  std::string getNodeLabel(const GraphNode *Node, const DebugInfo &DI) {
-    std::ostringstream OSS;
-    {
-      raw_os_ostream OS(OSS);
-      Node->printNodeLabel(DI, OS);
+  if (HasRoots) {
+    Output.write(GraphDepth);
+  } else {
+    // Everything, starting from the VIs.
+    SmallVector<GraphEdge, 16> Edges;
+    D->getOutgoingEdges(*D, Edges);
+    for (SmallVectorImpl<GraphEdge>::const_iterator i = Edges.begin(),
+                                                    End = Edges.end();
+         i != End; ++i) {
+      Output.addNode(i->getDestination(), 0);
     }
-    return OSS.str();
+    Output.write(~0u);
   }
-
-  static std::string getEdgeSourceLabel(const GraphNode *Node,
-                                        const NodeForwardIterator &i) {
-    return i.getLabel();
+  if (Output.isTruncated()) {
+    OS << "\t// Output stopped by -andersen-graph-max-size.\n";
+    errs() << "  graph truncated by -andersen-graph-max-size...";
   }
+  OS << "}\n";
+}
 
-  static bool isNodeHidden(const GraphNode *Node) {
-    return Node->isNodeHidden();
-  }
-};
+}
 
 void viewGraph(const Data *Data, const Module *M) {
-  ViewGraph(DebugInfo(Data), "AndersenPass", false, getGraphTitle(M));
+  int FD;
+  std::string Filename = createGraphFilename("AndersenPass", FD);
+  if (FD == -1) {
+    errs() << "error opening file '" << Filename << "' for writing!\n";
+    return;
+  }
+  {
+    raw_fd_ostream File(FD, /*shouldClose=*/ true);
+    writeGraph(File, Data, *M);
+  }
+  errs() << " done. \n";
+  DisplayGraph(Filename, true, GraphProgram::DOT);
 }
 
 void printGraph(const Data *Data, const Module *M) {
@@ -146,7 +302,7 @@ void printGraph(const Data *Data, const Module *M) {
   raw_fd_ostream File(Filename, ErrorInfo);
 
   if (ErrorInfo.empty()) {
-    WriteGraph(File, DebugInfo(Data), false, getGraphTitle(M));
+    writeGraph(File, Data, *M);
   } else {
     errs() << "  error opening file for writing!";
   }
@@ -158,7 +314,9 @@ public:
   explicit AndersenGraphPass(char &ID) : ModulePass(ID) {}
 
   virtual bool runOnModule(Module &M) {
-    process(getAnalysis<AndersenPass>().Data, M);
+    const Data *D = getAnalysis<AndersenPass>().Data;
+    BackgroundSolver::Guard G(D);
+    process(D, M);
     return false;
   }
 
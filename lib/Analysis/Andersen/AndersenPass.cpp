@@ -12,32 +12,245 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "andersen"
 #include "llvm/Analysis/AndersenPass.h"
 
+#include "AliasClasses.h"
 #include "AnalysisResult.h"
+#include "BackgroundSolver.h"
+#include "Components.h"
+#include "CostAttribution.h"
+#include "ConstraintFile.h"
 #include "Data.h"
 #include "DebugInfo.h"
+#include "Derivations.h"
+#include "EnumerationSession.h"
+#include "EnumerationTrace.h"
+#include "FinishedSet.h"
 #include "InstructionAnalyzer.h"
 #include "Phase.h"
 #include "PointsToAlgorithm.h"
+#include "RelationStore.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AndersenEnumerator.h"
-#include "llvm/Analysis/Dominators.h"
+#include "llvm/IR/Constant.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 namespace llvm {
 
 using namespace andersen_internal;
 
+STATISTIC(NumDisjointByUnification,
+          "Number of intersection queries answered by unification classes");
+STATISTIC(NumComponents, "Number of connected components of the relations");
+STATISTIC(NumExternalComponents,
+          "Number of components related to external regions");
+STATISTIC(LargestComponentSize, "Number of values in the largest component");
+STATISTIC(NumRecordedRelations,
+          "Number of relations recorded to build results from");
+
 namespace {
 
 cl::opt<bool> NonLazy("andersen-non-lazy",
                       cl::desc("Perform Andersen analysis non-lazily"));
 
-AndersenEnumerator enumerateRemaining(AnalysisResult *AR) {
-  return AndersenEnumerator(AR, AR->getSetContentsSoFar().size());
+cl::opt<bool> ComputeAliasClasses("andersen-alias-classes",
+    cl::desc("Solve all points-to sets and precompute alias classes of the "
+             "small ones"));
+
+cl::opt<unsigned> MaxAliasClasses("andersen-max-alias-classes",
+    cl::desc("Maximum number of alias classes to precompute"),
+    cl::init(4096));
+
+cl::opt<unsigned> MaxMemory("andersen-max-memory",
+    cl::desc("Approximate memory in megabytes for points-to sets above which "
+             "finished intermediate results are discarded and computed again "
+             "if needed (0 = unlimited)"),
+    cl::init(0));
+
+cl::opt<unsigned> MaxAliasClassSetSize("andersen-alias-class-max-set-size",
+    cl::desc("Maximum size of a points-to set assigned an alias class"),
+    cl::init(8));
+
+cl::opt<bool> Unify("andersen-unification",
+    cl::desc("Partition the points-to sets with a unification-based "
+             "pre-analysis and answer intersection queries across partitions "
+             "without enumeration"),
+    cl::init(true));
+
+cl::opt<bool> FindComponents("andersen-components",
+    cl::desc("Decompose the relations into connected components, solve them "
+             "one at a time in non-lazy mode, releasing the intermediate "
+             "results of each, and print their sizes"));
+
+cl::opt<bool> LazyRelations("andersen-lazy-relations",
+    cl::desc("Record the relations as compact edges and build the analysis "
+             "results from them only when first needed (disables "
+             "-andersen-renumber)"));
+
+cl::opt<bool> LazyInitializers("andersen-lazy-initializers",
+    cl::desc("Analyze aggregate global initializers only when first needed "
+             "(implies -andersen-lazy-relations, ignored with "
+             "-andersen-components)"));
+
+cl::opt<bool> Dematerialize("andersen-dematerialize",
+    cl::desc("Discard the bodies of functions read in lazily for the analysis "
+             "once their relations are extracted"));
+
+cl::opt<std::string> WriteConstraints("andersen-write-constraints",
+    cl::desc("Write the relations to the given constraint file for offline "
+             "solving with llvm-andersen (implies -andersen-lazy-relations, "
+             "disables -andersen-lazy-initializers)"),
+    cl::value_desc("filename"));
+
+enum BackgroundOrderTy {
+  NoBackground,
+  FunctionOrder,
+  ReferenceOrder
+};
+
+cl::opt<BackgroundOrderTy> BackgroundOrder("andersen-background",
+    cl::desc("Solve points-to sets on a background thread while later passes "
+             "run (ignored with -andersen-non-lazy, -andersen-alias-classes "
+             "and -andersen-max-memory, disables "
+             "-andersen-lazy-initializers)"),
+    cl::values(
+      clEnumValN(NoBackground, "none", "Do not solve in the background"),
+      clEnumValN(FunctionOrder, "functions",
+                 "Solve the sets of each function in module order"),
+      clEnumValN(ReferenceOrder, "referenced",
+                 "Solve the sets shared by the most values first"),
+      clEnumValEnd),
+    cl::init(NoBackground));
+
+cl::opt<unsigned> BackgroundChunk("andersen-background-chunk",
+    cl::desc("Units of enumeration work the background thread does between "
+             "chances for queries to run"),
+    cl::init(1000));
+
+cl::opt<std::string> TraceFile("andersen-trace",
+    cl::desc("Write the time spent in each query and in the enumeration of "
+             "each set to the given file in Chrome trace event format"),
+    cl::value_desc("filename"));
+
+cl::opt<unsigned> TraceMaxEvents("andersen-trace-max-events",
+    cl::desc("Maximum number of enumeration spans to keep for "
+             "-andersen-trace, which keeps every query span"),
+    cl::init(1000000));
+
+cl::opt<int> TraceMaxDepth("andersen-trace-max-depth",
+    cl::desc("Deepest nesting of enumerations that -andersen-trace times, "
+             "where 0 is the sets that queries enumerate directly"),
+    cl::init(0));
+
+cl::opt<unsigned> TraceMinDuration("andersen-trace-min-duration",
+    cl::desc("Shortest enumeration span in microseconds that -andersen-trace "
+             "keeps"),
+    cl::init(10));
+
+cl::opt<std::string> CostReportFile("andersen-cost-report",
+    cl::desc("Write the enumeration work induced by the relations of each "
+             "function to the given file, most first (disables "
+             "-andersen-share-transforms)"),
+    cl::value_desc("filename"));
+
+cl::opt<unsigned> CostReportMaxFunctions("andersen-cost-report-max-functions",
+    cl::desc("Maximum number of functions to list with -andersen-cost-report, "
+             "or 0 for all"),
+    cl::init(50));
+
+cl::opt<bool> RecordDerivations("andersen-record-derivations",
+    cl::desc("Record where enumeration finds the elements of each set and "
+             "which relations added its subsets, for -explain-andersen "
+             "(disables -andersen-share-transforms)"));
+
+cl::opt<bool> ShareTransforms("andersen-share-transforms",
+    cl::desc("Compute transforms of identical inputs only once"),
+    cl::init(true));
+
+cl::opt<bool> Renumber("andersen-renumber",
+    cl::desc("Renumber the values in traversal order before solving, so that "
+             "the elements of a set get nearby ids (requires "
+             "-andersen-lazy-relations=false)"));
+
+AndersenHandle getHandle(ValueInfo *VI) {
+  if (!VI) {
+    // We determined this points to nothing at instruction analysis time.
+    return 0;
+  }
+  return VI->getAlgorithmResult<PointsToAlgorithm, ENUMERATION_PHASE>();
+}
+
+// Enumerate what PointsToSetView(D, AR) does not show.
+AndersenEnumerator enumerateRemaining(Data *D, AnalysisResult *AR) {
+  uint32_t UniversePos = 0;
+  if (AR->isDone() && AR->containsUniverse()) {
+    UniversePos = D->getUniverse()->getSetContentsSoFar().size();
+  }
+  return AndersenEnumerator(AR, AR->getSetContentsSoFar().size(),
+                            UniversePos);
+}
+
+// Finish any deferred work of AR, and of the universe if AR holds it. Returns
+// false if Session ran out of budget first.
+bool solve(Data *D, AnalysisResult *AR, EnumerationSession *Session) {
+  if (!AR->isDone()) {
+    for (AndersenEnumerator AE(enumerateRemaining(D, AR));
+         AE.enumerate(Session); );
+    if (Session && Session->isSuspended()) {
+      return false;
+    }
+    assert(AR->isDone());
+  }
+  if (AR->containsUniverse()) {
+    return solve(D, D->getUniverse(), Session);
+  }
+  return true;
+}
+
+// Determine whether AR is empty, computing at most its first element. Returns
+// false if Session ran out of budget first.
+bool checkEmpty(Data *D, AnalysisResult *AR, EnumerationSession *Session,
+                bool &Empty) {
+  if (!AR) {
+    Empty = true;
+    return true;
+  }
+  Empty = AndersenEnumerator(AR).enumerate(Session) == 0;
+  return !(Session && Session->isSuspended());
+}
+
+bool isBackgroundEnabled() {
+  return BackgroundOrder != NoBackground && !NonLazy && !ComputeAliasClasses &&
+         !MaxMemory;
+}
+
+// Append the handle of VI to Queue unless it is done or already there.
+void enqueue(ValueInfo *VI, SmallPtrSet<AnalysisResult *, 256> &Seen,
+             std::vector<AnalysisResult *> &Queue) {
+  AnalysisResult *AR = getHandle(VI);
+  if (AR && !AR->isDone() && Seen.insert(AR)) {
+    Queue.push_back(AR);
+  }
+}
+
+bool compareReferences(const std::pair<unsigned, ValueInfo *> &A,
+                       const std::pair<unsigned, ValueInfo *> &B) {
+  // Most referenced first, then by id for a deterministic order.
+  if (A.first != B.first) {
+    return A.first > B.first;
+  }
+  return A.second->getId() < B.second->getId();
 }
 
 void writeEquations(const Data *Data, raw_ostream &OS) {
@@ -47,28 +260,98 @@ void writeEquations(const Data *Data, raw_ostream &OS) {
 
 }
 
+void PointsToSetView::const_iterator::skipListed() {
+  if (i < NumListed) {
+    return;
+  }
+  const ValueInfoIdSetVector &Set = AR->getSetContentsSoFar();
+  const ValueInfoIdSetVector &Universe =
+      D->getUniverse()->getSetContentsSoFar();
+  while (i != End && Set.count(Universe[i - NumListed])) {
+    ++i;
+  }
+}
+
+ValueInfo *PointsToSetView::const_iterator::operator*() const {
+  assert(i != End);
+  if (i < NumListed) {
+    return D->getValueInfo(AR->getSetContentsSoFar()[i]);
+  }
+  const ValueInfoIdSetVector &Universe =
+      D->getUniverse()->getSetContentsSoFar();
+  return D->getValueInfo(Universe[i - NumListed]);
+}
+
+PointsToSetView::PointsToSetView(const Data *D, const AnalysisResult *AR)
+  : D(D), AR(AR), NumListed(AR->getSetContentsSoFar().size()),
+    NumUniverse(0) {
+  if (AR->isDone() && AR->containsUniverse()) {
+    NumUniverse = D->getUniverse()->getSetContentsSoFar().size();
+  }
+}
+
+size_t PointsToSetView::size() const {
+  size_t Size = NumListed;
+  for (const_iterator i(*this, NumListed), End = end(); i != End; ++i) {
+    ++Size;
+  }
+  return Size;
+}
+
+bool PointsToSetView::count(const ValueInfo *VI) const {
+  if (!AR) {
+    return false;
+  }
+  return AR->getSetContentsSoFar().count(VI->getId()) ||
+         (NumUniverse &&
+          D->getUniverse()->getSetContentsSoFar().count(VI->getId()));
+}
+
 char AndersenPass::ID = 0;
 
 AndersenPass::AndersenPass()
-  : ModulePass(ID), Data(0) {
+  : ModulePass(ID), Data(0), Solver(0), Trace(0), Costs(0) {
   initializeAndersenPassPass(*PassRegistry::getPassRegistry());
 }
 
 AndersenHandle AndersenPass::getHandleToPointsToSet(const Value *V) const {
+  AndersenHandle AH;
+  return getHandleToPointsToSet(V, AH) ? AH : 0;
+}
+
+bool AndersenPass::getHandleToPointsToSet(const Value *V,
+                                          AndersenHandle &AH) const {
   assert(V);
-  ValueInfoMap::const_iterator i = Data->ValueInfos.find(V);
-  if (i == Data->ValueInfos.end()) {
-    // This can only happen if we are being queried for an unreachable
-    // instruction. Pretend its result points to nothing.
+  BackgroundSolver::Guard G(Data);
+  ValueInfo *VI;
+  if (!Data->lookupValueInfo(V, VI)) {
+    if (Data->isInChangedBody(V)) {
+      // V may have been added after analysis.
+      return false;
+    }
+    const Constant *C = dyn_cast<Constant>(V);
+    if (C && C->getNumOperands()) {
+      // A constant only held by initializers that are still deferred gets its
+      // VI when they are analyzed. One made by a later pass has none. Those
+      // without operands, like undef, point to nothing.
+      if (Data->Relations) {
+        Data->Relations->addDeferredRelationsUsing(V);
+      }
+      if (!Data->lookupValueInfo(V, VI)) {
+        return false;
+      }
+      AH = getHandle(VI);
+      return true;
+    }
+    // Else this can only happen if we are being queried for an unreachable
+    // instruction or a constant without operands. Pretend its result points
+    // to nothing.
     // TODO: Write an assert that verifies this.
-    return 0;
+    AH = 0;
+    return true;
   }
-  ValueInfo *VI = i->second.getPtr();
-  if (!VI) {
-    // We determined this points to nothing at instruction analysis time.
-    return 0;
-  }
-  return VI->getAlgorithmResult<PointsToAlgorithm, ENUMERATION_PHASE>();
+  AH = getHandle(VI);
+  return true;
 }
 
 const PointsToSet *AndersenPass::getPointsToSet(AndersenHandle AH) const {
@@ -77,21 +360,37 @@ const PointsToSet *AndersenPass::getPointsToSet(AndersenHandle AH) const {
     // We determined this points to nothing at instruction analysis time.
     return 0;
   }
-  // Else it could point to something. Finish any deferred work.
-  if (!AR->isDone()) {
-    for (AndersenEnumerator AE(enumerateRemaining(AR)); AE.enumerate(); );
-    assert(AR->isDone());
-  }
-  if (AR->getSetContentsSoFar().empty()) {
+  BackgroundSolver::Guard G(Data);
+  PointsToSetView View = getPointsToSetView(AR);
+  if (View.empty()) {
     // Doesn't point to anything after all. Return null for consistency.
     return 0;
   }
-  return &AR->getSetContentsSoFar();
+  return &Data->getSetCopy(AR);
+}
+
+PointsToSetView AndersenPass::getPointsToSetView(AndersenHandle AH) const {
+  AnalysisResult *AR = AH;
+  if (!AR) {
+    // We determined this points to nothing at instruction analysis time.
+    return PointsToSetView();
+  }
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("getPointsToSet", AR);
+  // Else it could point to something. Finish any deferred work.
+  solve(Data, AR, 0);
+  relieveMemoryPressure();
+  return PointsToSetView(Data, AR);
 }
 
 bool AndersenPass::isPointsToSetEmpty(AndersenHandle AH) const {
   AnalysisResult *AR = AH;
-  return !AR || AndersenEnumerator(AR).enumerate() == 0;
+  if (!AR) {
+    return true;
+  }
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("isPointsToSetEmpty", AR);
+  return AndersenEnumerator(AR).enumerate() == 0;
 }
 
 AndersenEnumerator AndersenPass::enumeratePointsToSet(AndersenHandle AH) const {
@@ -103,14 +402,34 @@ AndersenEnumerator AndersenPass::enumeratePointsToSet(AndersenHandle AH) const {
   return AndersenEnumerator(AR);
 }
 
-const PointsToSet *AndersenPass::getPointsToSetContentsSoFar(AndersenHandle AH)
-    const {
+const PointsToSet *AndersenPass::getPointsToSetContentsSoFar(
+    AndersenHandle AH) const {
   AnalysisResult *AR = AH;
   if (!AR) {
     // We determined this points to nothing at instruction analysis time.
     return 0;
   }
-  return &AR->getSetContentsSoFar();
+  BackgroundSolver::Guard G(Data);
+  getPointsToSetContentsSoFarView(AR);
+  return &Data->getSetCopy(AR);
+}
+
+PointsToSetView AndersenPass::getPointsToSetContentsSoFarView(
+    AndersenHandle AH) const {
+  AnalysisResult *AR = AH;
+  if (!AR) {
+    // We determined this points to nothing at instruction analysis time.
+    return PointsToSetView();
+  }
+  if (Solver) {
+    // The thread would change the contents while the view is read, but it
+    // leaves done sets alone.
+    BackgroundSolver::Guard G(Data);
+    EnumerationTrace::Span TraceSpan("getPointsToSetContentsSoFar", AR);
+    solve(Data, AR, 0);
+    return PointsToSetView(Data, AR);
+  }
+  return PointsToSetView(Data, AR);
 }
 
 AndersenEnumerator AndersenPass::enumeratePointsToSetContentsRemaining(
@@ -120,33 +439,495 @@ AndersenEnumerator AndersenPass::enumeratePointsToSetContentsRemaining(
     // We determined this points to nothing at instruction analysis time.
     return AndersenEnumerator(&Data->EmptyAnalysisResult);
   }
-  return enumerateRemaining(AR);
+  return enumerateRemaining(Data, AR);
+}
+
+bool AndersenPass::doPointsToSetsIntersect(AndersenHandle A, AndersenHandle B)
+    const {
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("doPointsToSetsIntersect", A, B);
+  bool Result;
+  bool Answered = intersect(A, B, 0, Result);
+  assert(Answered);
+  (void)Answered;
+  relieveMemoryPressure();
+  return Result;
+}
+
+bool AndersenPass::tryPointsToSetsIntersect(AndersenHandle A, AndersenHandle B,
+                                            unsigned Budget, bool &Result)
+    const {
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("tryPointsToSetsIntersect", A, B);
+  EnumerationSession Session(Budget);
+  bool Answered = intersect(A, B, &Session, Result);
+  relieveMemoryPressure();
+  return Answered;
+}
+
+bool AndersenPass::explainMembership(AndersenHandle AH, ValueInfo *VI,
+                                     raw_ostream &OS) const {
+  BackgroundSolver::Guard G(Data);
+  AnalysisResult *AR = AH;
+  bool Found = AR && AR->countSoFar(*Data, VI->getId());
+  if (AR && !Found) {
+    AndersenEnumerator AE(enumerateRemaining(Data, AR));
+    while (ValueInfo *Next = AE.enumerate()) {
+      if (Next == VI) {
+        Found = true;
+        break;
+      }
+    }
+  }
+  if (!Found) {
+    OS << "Not in the set\n";
+    return false;
+  }
+  if (!Data->Derivs) {
+    OS << "Derivations not recorded; use -andersen-record-derivations\n";
+    return true;
+  }
+  Data->Derivs->explain(DebugInfo(Data), AR, VI, OS);
+  return true;
+}
+
+bool AndersenPass::intersect(AndersenHandle A, AndersenHandle B,
+                             EnumerationSession *Session, bool &Result) const {
+  BackgroundSolver::Guard G(Data);
+  if (A && B &&
+      A->getUnificationClass() != AnalysisResult::NoUnificationClass &&
+      B->getUnificationClass() != AnalysisResult::NoUnificationClass &&
+      A->getUnificationClass() != B->getUnificationClass()) {
+    ++NumDisjointByUnification;
+    Result = false;
+    return true;
+  }
+  if (Data->Classes && A && B &&
+      A->getAliasClass() != AnalysisResult::NoAliasClass &&
+      B->getAliasClass() != AnalysisResult::NoAliasClass) {
+    Result = Data->Classes->mayOverlap(A->getAliasClass(), B->getAliasClass());
+    return true;
+  }
+  bool Empty;
+  if (!checkEmpty(Data, A, Session, Empty)) return false;
+  if (!Empty && !checkEmpty(Data, B, Session, Empty)) return false;
+  if (Empty) {
+    Result = false;
+    return true;
+  }
+  if (A->containsUniverse() && B->containsUniverse()) {
+    // Both hold all of the universe, so they meet unless it is empty.
+    if (!checkEmpty(Data, Data->getUniverse(), Session, Empty)) return false;
+    if (!Empty) {
+      Result = true;
+      return true;
+    }
+  }
+  if (!A->isDone() && B->isDone()) {
+    // Prefer to lazily enumerate the one that isn't done.
+    std::swap(A, B);
+  }
+  // TODO: What is the optimal enumeration strategy?
+  if (!solve(Data, B, Session)) return false;
+  if (A->isDone()) {
+    // Both fully computed, so compare their compact forms.
+    const FinishedSet *FinishedA = Data->getFinishedSet(A, Session);
+    if (!FinishedA) return false;
+    const FinishedSet *FinishedB = Data->getFinishedSet(B, Session);
+    if (!FinishedB) return false;
+    Result = FinishedA->intersects(*FinishedB);
+    return true;
+  }
+  for (AndersenEnumerator AE(A);; ) {
+    ValueInfo *Next = AE.enumerate(Session);
+    if (!Next) break;
+    if (B->countSoFar(*Data, Next->getId())) {
+      Result = true;
+      return true;
+    }
+  }
+  if (Session && Session->isSuspended()) return false;
+  Result = false;
+  return true;
+}
+
+void AndersenPass::getPointsToSets(ArrayRef<const Value *> Values,
+    MutableArrayRef<const PointsToSet *> Results) const {
+  assert(Values.size() == Results.size());
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("getPointsToSets", 0);
+  SmallVector<AndersenHandle, 64> Handles;
+  solveAll(Values, Handles);
+  for (size_t i = 0, End = Handles.size(); i != End; ++i) {
+    // Already solved, so skip the per-query work of getPointsToSet.
+    const PointsToSet *Set = 0;
+    if (Handles[i] && !PointsToSetView(Data, Handles[i]).empty()) {
+      Set = &Data->getSetCopy(Handles[i]);
+    }
+    Results[i] = Set;
+  }
+}
+
+void AndersenPass::getPointsToSets(ArrayRef<const Value *> Values,
+    MutableArrayRef<PointsToSetView> Results) const {
+  assert(Values.size() == Results.size());
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("getPointsToSets", 0);
+  SmallVector<AndersenHandle, 64> Handles;
+  solveAll(Values, Handles);
+  for (size_t i = 0, End = Handles.size(); i != End; ++i) {
+    // Already solved, so skip the per-query work of getPointsToSetView.
+    Results[i] = Handles[i] ? PointsToSetView(Data, Handles[i])
+                            : PointsToSetView();
+  }
+}
+
+void AndersenPass::doPointsToSetsIntersect(
+    ArrayRef<std::pair<const Value *, const Value *> > Pairs,
+    MutableArrayRef<bool> Results) const {
+  assert(Pairs.size() == Results.size());
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("doPointsToSetsIntersect (batch)", 0);
+  SmallVector<AndersenHandle, 128> Handles;
+  Handles.reserve(Pairs.size() * 2);
+  for (ArrayRef<std::pair<const Value *, const Value *> >::iterator
+           i = Pairs.begin(), End = Pairs.end();
+       i != End; ++i) {
+    Handles.push_back(getHandleToPointsToSet(i->first));
+    Handles.push_back(getHandleToPointsToSet(i->second));
+  }
+  solveAll(Handles);
+  for (size_t i = 0, End = Pairs.size(); i != End; ++i) {
+    // The sets are done, so this only compares them.
+    bool Result;
+    bool Answered = intersect(Handles[2 * i], Handles[2 * i + 1], 0, Result);
+    assert(Answered);
+    (void)Answered;
+    Results[i] = Result;
+  }
+  relieveMemoryPressure();
+}
+
+void AndersenPass::solveAll(ArrayRef<AndersenHandle> Handles) const {
+  // Solve the distinct unfinished sets in one go, with the inputs of their
+  // pending work first. Each shared subset is then finished once, on its own,
+  // and the sets that read it find it done instead of entering it again and
+  // repeating its cycle handling from their own enumeration.
+  BackgroundSolver::Guard G(Data);
+  EnumerationTrace::Span TraceSpan("solveAll", 0);
+  std::vector<AnalysisResult *> Order;
+  Data->getSolveOrder(Handles, Order);
+  for (std::vector<AnalysisResult *>::const_iterator i = Order.begin(),
+                                                     End = Order.end();
+       i != End; ++i) {
+    solve(Data, *i, 0);
+  }
+  relieveMemoryPressure();
+}
+
+void AndersenPass::solveAll(ArrayRef<const Value *> Values,
+                            SmallVectorImpl<AndersenHandle> &Handles) const {
+  Handles.reserve(Handles.size() + Values.size());
+  for (ArrayRef<const Value *>::iterator i = Values.begin(),
+                                         End = Values.end();
+       i != End; ++i) {
+    Handles.push_back(getHandleToPointsToSet(*i));
+  }
+  solveAll(Handles);
+}
+
+void AndersenPass::solveAllByComponent() const {
+  // Solve one component at a time, and release the intermediate results of
+  // its VIs once it is finished, before the next one starts. The sets of an
+  // external component can read those of other components through the
+  // universe, so only the other components are released. Sets of the special
+  // VIs go last.
+  const Components &Comps = *Data->Comps;
+  std::vector<std::vector<AndersenHandle> > Buckets(
+      Comps.getNumComponents() + 1);
+  for (ValueInfoMap::const_iterator i = Data->ValueInfos.begin(),
+                                    End = Data->ValueInfos.end();
+       i != End; ++i) {
+    if (!i->second) continue;
+    uint32_t C = Comps.getComponent(i->second.getPtr());
+    if (C == Components::NoComponent) {
+      C = Comps.getNumComponents();
+    }
+    Buckets[C].push_back(getHandleToPointsToSet(i->first));
+  }
+  for (FunctionBodyMap::const_iterator
+           i = Data->DematerializedValueInfos.begin(),
+           End = Data->DematerializedValueInfos.end();
+       i != End; ++i) {
+    for (ValueInfoVector::const_iterator j = i->second.begin(),
+                                         JEnd = i->second.end();
+         j != JEnd; ++j) {
+      if (!*j) continue;
+      uint32_t C = Comps.getComponent(j->getPtr());
+      if (C == Components::NoComponent) {
+        C = Comps.getNumComponents();
+      }
+      Buckets[C].push_back(getHandle(j->getPtr()));
+    }
+  }
+  // All VIs of each component, including regions and anonymous ones, whose
+  // pending work must be known before any result of the component goes.
+  std::vector<std::vector<ValueInfo *> > Members(Comps.getNumComponents());
+  for (uint32_t Id = 0, End = Data->getNumValueInfos(); Id != End; ++Id) {
+    ValueInfo *VI = Data->getValueInfo(Id);
+    uint32_t C = Comps.getComponent(VI);
+    if (C != Components::NoComponent) {
+      Members[C].push_back(VI);
+    }
+  }
+  for (uint32_t C = 0, End = Buckets.size(); C != End; ++C) {
+    solveAll(Buckets[C]);
+    if (C != Comps.getNumComponents() && !Comps.isExternal(C)) {
+      Data->releaseIntermediateResults(Members[C]);
+    }
+  }
+}
+
+void AndersenPass::startBackgroundSolver(const Module &M) {
+  // Create the handles here, since creating them builds results.
+  std::vector<AnalysisResult *> Queue;
+  SmallPtrSet<AnalysisResult *, 256> Seen;
+  if (BackgroundOrder == FunctionOrder) {
+    for (Module::const_iterator F = M.begin(), FEnd = M.end(); F != FEnd;
+         ++F) {
+      ValueInfo *VI;
+      for (Function::const_arg_iterator A = F->arg_begin(),
+                                        AEnd = F->arg_end();
+           A != AEnd; ++A) {
+        if (Data->lookupValueInfo(A, VI)) {
+          enqueue(VI, Seen, Queue);
+        }
+      }
+      FunctionBodyMap::const_iterator Body =
+          Data->DematerializedValueInfos.find(F);
+      if (Body != Data->DematerializedValueInfos.end()) {
+        for (ValueInfoVector::const_iterator i = Body->second.begin(),
+                                             End = Body->second.end();
+             i != End; ++i) {
+          enqueue(i->getPtr(), Seen, Queue);
+        }
+        continue;
+      }
+      for (Function::const_iterator BB = F->begin(), BBEnd = F->end();
+           BB != BBEnd; ++BB) {
+        for (BasicBlock::const_iterator I = BB->begin(), IEnd = BB->end();
+             I != IEnd; ++I) {
+          if (Data->lookupValueInfo(I, VI)) {
+            enqueue(VI, Seen, Queue);
+          }
+        }
+      }
+    }
+  } else {
+    // Count the values sharing each VI, which is how many different queries
+    // its set can answer.
+    DenseMap<ValueInfo *, unsigned> References;
+    for (ValueInfoMap::const_iterator i = Data->ValueInfos.begin(),
+                                      End = Data->ValueInfos.end();
+         i != End; ++i) {
+      if (i->second) {
+        ++References[i->second.getPtr()];
+      }
+    }
+    for (FunctionBodyMap::const_iterator
+             i = Data->DematerializedValueInfos.begin(),
+             End = Data->DematerializedValueInfos.end();
+         i != End; ++i) {
+      for (ValueInfoVector::const_iterator j = i->second.begin(),
+                                           JEnd = i->second.end();
+           j != JEnd; ++j) {
+        if (*j) {
+          ++References[j->getPtr()];
+        }
+      }
+    }
+    std::vector<std::pair<unsigned, ValueInfo *> > Order;
+    Order.reserve(References.size());
+    for (DenseMap<ValueInfo *, unsigned>::const_iterator
+             i = References.begin(), End = References.end();
+         i != End; ++i) {
+      Order.push_back(std::make_pair(i->second, i->first));
+    }
+    std::sort(Order.begin(), Order.end(), compareReferences);
+    for (std::vector<std::pair<unsigned, ValueInfo *> >::const_iterator
+             i = Order.begin(), End = Order.end();
+         i != End; ++i) {
+      enqueue(i->second, Seen, Queue);
+    }
+  }
+  if (Queue.empty()) {
+    return;
+  }
+  Solver = new BackgroundSolver(Data, Queue, BackgroundChunk);
+  if (!Solver->start()) {
+    // No threads in this build.
+    delete Solver;
+    Solver = 0;
+  }
+}
+
+void AndersenPass::writeConstraintFile(const Module &M) const {
+  assert(Data->Relations && "The file is written from the recorded relations");
+  errs() << "Writing '" << WriteConstraints << "'...";
+
+  std::string ErrorInfo;
+  raw_fd_ostream File(WriteConstraints.c_str(), ErrorInfo,
+                      raw_fd_ostream::F_Binary);
+
+  if (ErrorInfo.empty()) {
+    ConstraintFile::write(*Data, M, File);
+  } else {
+    errs() << "  error opening file for writing!";
+  }
+  errs() << "\n";
+}
+
+void AndersenPass::startTrace() {
+  errs() << "Writing '" << TraceFile << "'...";
+
+  std::string ErrorInfo;
+  OwningPtr<raw_fd_ostream> File(new raw_fd_ostream(TraceFile.c_str(),
+                                                    ErrorInfo));
+
+  if (ErrorInfo.empty()) {
+    Trace = new EnumerationTrace(Data, File.take(), TraceMaxEvents,
+                                 TraceMaxDepth, TraceMinDuration);
+  } else {
+    errs() << "  error opening file for writing!";
+  }
+  errs() << "\n";
+}
+
+void AndersenPass::writeCostReport() const {
+  errs() << "Writing '" << CostReportFile << "'...";
+
+  std::string ErrorInfo;
+  raw_fd_ostream File(CostReportFile.c_str(), ErrorInfo);
+
+  if (ErrorInfo.empty()) {
+    Costs->print(File, CostReportMaxFunctions);
+  } else {
+    errs() << "  error opening file for writing!";
+  }
+  errs() << "\n";
+}
+
+void AndersenPass::relieveMemoryPressure() const {
+  if (MaxMemory) {
+    Data->relieveMemoryPressure(size_t(MaxMemory) << 20);
+  }
 }
 
 bool AndersenPass::runOnModule(Module &M) {
   assert(!Data);
-  Data = InstructionAnalyzer::run(this, M);
-  if (NonLazy) {
+  // Before instruction analysis, which tags the relations.
+  if (!CostReportFile.empty()) {
+    Costs = new CostAttribution();
+  }
+  Derivations *Derivs = RecordDerivations ? new Derivations() : 0;
+  // The file is written from the recorded relations and needs all of them up
+  // front, and deferred initializers are found through use lists, which later
+  // passes may change while the background thread runs.
+  bool DeferInitializers = LazyInitializers && WriteConstraints.empty() &&
+                           !isBackgroundEnabled();
+  Data = InstructionAnalyzer::run(M, Unify, FindComponents,
+                                  LazyRelations || DeferInitializers ||
+                                      !WriteConstraints.empty(),
+                                  DeferInitializers, Dematerialize);
+  Data->Derivs = Derivs;
+  if (!WriteConstraints.empty()) {
+    writeConstraintFile(M);
+  }
+  if (Data->Relations) {
+    NumRecordedRelations = Data->Relations->getNumRelations();
+  }
+  if (Data->Comps) {
+    const Components &Comps = *Data->Comps;
+    NumComponents = Comps.getNumComponents();
+    for (uint32_t i = 0, End = Comps.getNumComponents(); i != End; ++i) {
+      if (Comps.isExternal(i)) {
+        ++NumExternalComponents;
+      }
+      if (Comps.getSize(i) > LargestComponentSize) {
+        LargestComponentSize = Comps.getSize(i);
+      }
+    }
+  }
+  // Sharing replaces the work that the cost report and the derivations
+  // record. With relations, results are shared as they are built instead.
+  if (ShareTransforms && !Costs && !Derivs) {
+    if (Data->Relations) {
+      Data->Relations->setShareTransforms(true);
+    } else {
+      Data->shareTransformResults();
+    }
+  }
+  // Renumbering would invalidate the ids in the recorded relations.
+  if (Renumber && !Data->Relations) {
+    Data->renumber();
+  }
+  if (!TraceFile.empty()) {
+    startTrace();
+  }
+  if ((NonLazy || ComputeAliasClasses) && Data->Comps) {
+    solveAllByComponent();
+  } else if (NonLazy || ComputeAliasClasses) {
     for (ValueInfoMap::const_iterator i = Data->ValueInfos.begin(),
                                       End = Data->ValueInfos.end();
          i != End; ++i) {
-      getPointsToSet(getHandleToPointsToSet(i->first));
+      getPointsToSetView(getHandleToPointsToSet(i->first));
     }
+    for (FunctionBodyMap::const_iterator
+             i = Data->DematerializedValueInfos.begin(),
+             End = Data->DematerializedValueInfos.end();
+         i != End; ++i) {
+      for (ValueInfoVector::const_iterator j = i->second.begin(),
+                                           JEnd = i->second.end();
+           j != JEnd; ++j) {
+        getPointsToSetView(getHandle(j->getPtr()));
+      }
+    }
+  }
+  if (ComputeAliasClasses) {
+    Data->Classes = new AliasClasses(Data, MaxAliasClasses,
+                                     MaxAliasClassSetSize);
+  }
+  if (isBackgroundEnabled()) {
+    startBackgroundSolver(M);
   }
   return false;
 }
 
 void AndersenPass::releaseMemory() {
+  // Stops the thread, which must not outlive Data.
+  delete Solver;
+  Solver = 0;
+  // Writes the rest of the trace, which needs Data to name the sets.
+  delete Trace;
+  Trace = 0;
+  if (Costs) {
+    writeCostReport();
+    delete Costs;
+    Costs = 0;
+  }
   delete Data;
   Data = 0;
 }
 
 void AndersenPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
-  AU.addRequired<DominatorTree>();
 }
 
 void AndersenPass::print(raw_ostream &OS, const Module *M) const {
+  BackgroundSolver::Guard G(Data);
+  if (Data->Comps) {
+    Data->Comps->print(OS, 10);
+  }
   writeEquations(Data, OS);
 }
 
@@ -177,10 +958,5 @@ void dumpAnalysis(const Data *Data) {
 using namespace llvm;
 
 // TODO: What do these two bools mean?
-INITIALIZE_PASS_BEGIN(AndersenPass, "andersen",
-                      "Andersen's Algorithm for Points-To Analysis", false,
-                      true)
-INITIALIZE_PASS_DEPENDENCY(DominatorTree)
-INITIALIZE_PASS_END(AndersenPass, "andersen",
-                    "Andersen's Algorithm for Points-To Analysis", false,
-                    true)
+INITIALIZE_PASS(AndersenPass, "andersen",
+                "Andersen's Algorithm for Points-To Analysis", false, true)
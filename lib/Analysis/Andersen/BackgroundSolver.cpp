@@ -0,0 +1,144 @@
+//===- BackgroundSolver.cpp - speculative solving on a thread -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type that solves points-to sets on a background thread
+// while the rest of the pass pipeline runs, so that later queries find them
+// done.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "andersen"
+#include "BackgroundSolver.h"
+
+#include "AnalysisResult.h"
+#include "Data.h"
+#include "EnumerationSession.h"
+#include "EnumerationTrace.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AndersenEnumerator.h"
+#include "llvm/Config/config.h"
+
+#include <cassert>
+
+#if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#define HAVE_BACKGROUND_THREAD 1
+#endif
+
+namespace llvm {
+namespace andersen_internal {
+
+STATISTIC(NumBackgroundSolved, "Number of sets solved in the background");
+
+BackgroundSolver::Guard::Guard(const Data *D)
+  : BS(D->Solver), Waited(false) {
+  if (BS && !BS->Lock.tryacquire()) {
+    // The thread is enumerating. Holding Turn makes it let us in when its
+    // chunk ends.
+    BS->Turn.acquire();
+    BS->Lock.acquire();
+    Waited = true;
+  }
+}
+
+BackgroundSolver::Guard::~Guard() {
+  if (BS) {
+    BS->Lock.release();
+    if (Waited) {
+      BS->Turn.release();
+    }
+  }
+}
+
+BackgroundSolver::BackgroundSolver(Data *D,
+                                   const std::vector<AnalysisResult *> &Queue,
+                                   unsigned Chunk)
+  : D(D), Queue(Queue), Next(0), Chunk(Chunk ? Chunk : 1), Stopping(false),
+    Running(false), Thread(0) {}
+
+BackgroundSolver::~BackgroundSolver() {
+  stop();
+}
+
+void *BackgroundSolver::runThread(void *Arg) {
+  static_cast<BackgroundSolver *>(Arg)->run();
+  return 0;
+}
+
+void BackgroundSolver::run() {
+  for (;;) {
+    Lock.acquire();
+    if (Stopping || Next == Queue.size()) {
+      Lock.release();
+      return;
+    }
+    EnumerationTrace::setThread(1);
+    AnalysisResult *AR = Queue[Next];
+    if (AR->isDone()) {
+      // Solved by a query meanwhile.
+      ++Next;
+    } else {
+      EnumerationSession Session(Chunk);
+      for (AndersenEnumerator AE(AR, AR->getSetContentsSoFar().size());
+           AE.enumerate(&Session); );
+      if (!Session.isSuspended()) {
+        assert(AR->isDone());
+        ++NumBackgroundSolved;
+        ++Next;
+      }
+    }
+    EnumerationTrace::setThread(0);
+    Lock.release();
+    // Wait for any query that holds Turn to finish.
+    Turn.acquire();
+    Turn.release();
+  }
+}
+
+bool BackgroundSolver::start() {
+#ifdef HAVE_BACKGROUND_THREAD
+  assert(!Running);
+  if (D->Solver) {
+    return false;
+  }
+  pthread_t *T = new pthread_t;
+  // Guards on D from now on lock, and none can be held yet.
+  D->Solver = this;
+  if (::pthread_create(T, 0, &runThread, this) != 0) {
+    D->Solver = 0;
+    delete T;
+    return false;
+  }
+  Thread = T;
+  Running = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void BackgroundSolver::stop() {
+#ifdef HAVE_BACKGROUND_THREAD
+  if (!Running) {
+    return;
+  }
+  Lock.acquire();
+  Stopping = true;
+  Lock.release();
+  pthread_t *T = static_cast<pthread_t *>(Thread);
+  ::pthread_join(*T, 0);
+  delete T;
+  Thread = 0;
+  Running = false;
+  D->Solver = 0;
+#endif
+}
+
+}
+}
@@ -0,0 +1,85 @@
+//===- BackgroundSolver.h - speculative solving on a thread ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type that solves points-to sets on a background thread
+// while the rest of the pass pipeline runs, so that later queries find them
+// done.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef BACKGROUNDSOLVER_H
+#define BACKGROUNDSOLVER_H
+
+#include "llvm/Support/Mutex.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace llvm {
+namespace andersen_internal {
+
+class AnalysisResult;
+class Data;
+
+// Nothing in the analysis is thread-safe, so the thread holds a lock on its
+// data while it enumerates, and lets any query waiting for the lock in after
+// every Chunk units of work. Queries take the lock through a Guard, which does
+// nothing unless a solver is running on the data they read, so the solvers of
+// other data never block them.
+class BackgroundSolver {
+  // The data the sets belong to.
+  Data *const D;
+  // The sets to solve, in order.
+  std::vector<AnalysisResult *> Queue;
+  size_t Next;
+  const unsigned Chunk;
+  sys::Mutex Lock;
+  // Held by a query from before it waits for Lock until it is done with it, so
+  // that the thread waits for the query at the end of its chunk instead of
+  // taking Lock again first.
+  sys::Mutex Turn;
+  // Whether the thread should exit. Guarded by Lock.
+  bool Stopping;
+  // Whether the thread was started and not yet joined.
+  bool Running;
+  // The thread, as an opaque pointer so that this header does not need the
+  // platform's thread type.
+  void *Thread;
+
+  static void *runThread(void *Arg);
+  void run();
+
+public:
+  class Guard {
+    BackgroundSolver *const BS;
+    // Whether this Guard waited its turn, and so holds Turn as well.
+    bool Waited;
+
+  public:
+    explicit Guard(const Data *D);
+    ~Guard();
+  };
+
+  BackgroundSolver(Data *D, const std::vector<AnalysisResult *> &Queue,
+                   unsigned Chunk);
+  // Stops the thread.
+  ~BackgroundSolver();
+
+  // Start the thread. Returns false if threads are not available or the data
+  // already has a solver.
+  bool start();
+
+  // Stop the thread after its current chunk and wait for it.
+  void stop();
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,190 @@
+//===- Components.cpp - connected components of the constraints -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type for the decomposition of the ValueInfos into the
+// connected components of the relations between them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Components.h"
+
+#include "ValueInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Value.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+const Function *getFunction(const Value *V) {
+  if (const Instruction *I = dyn_cast<Instruction>(V)) {
+    return I->getParent()->getParent();
+  }
+  if (const Argument *A = dyn_cast<Argument>(V)) {
+    return A->getParent();
+  }
+  return 0;
+}
+
+struct LargerComponent {
+  const Components *C;
+
+  explicit LargerComponent(const Components *C) : C(C) {}
+
+  bool operator()(uint32_t A, uint32_t B) const {
+    return C->getSize(A) > C->getSize(B);
+  }
+};
+
+}
+
+const uint32_t Components::NoComponent;
+
+Components::Components(const ValueInfo *ExternallyLinkableRegions,
+                       const ValueInfo *ExternallyAccessibleRegions)
+  : ExternallyLinkableRegions(ExternallyLinkableRegions),
+    ExternallyAccessibleRegions(ExternallyAccessibleRegions),
+    Finished(false) {}
+
+uint32_t Components::getNode(const ValueInfo *VI) {
+  assert(!Finished);
+  assert(!isPlaceholder(VI));
+  std::pair<DenseMap<const ValueInfo *, uint32_t>::iterator, bool> P =
+      Nodes.insert(std::make_pair(VI, uint32_t(Parent.size())));
+  if (P.second) {
+    Parent.push_back(P.first->second);
+    External.push_back(false);
+  }
+  return P.first->second;
+}
+
+uint32_t Components::find(uint32_t N) {
+  uint32_t Root = N;
+  while (Parent[Root] != Root) {
+    Root = Parent[Root];
+  }
+  while (Parent[N] != Root) {
+    uint32_t Next = Parent[N];
+    Parent[N] = Root;
+    N = Next;
+  }
+  return Root;
+}
+
+void Components::addValueInfo(const ValueInfo *VI) {
+  if (!isPlaceholder(VI)) {
+    getNode(VI);
+  }
+}
+
+void Components::addRelation(const ValueInfo *Src, const ValueInfo *Dst) {
+  bool SrcIsPlaceholder = isPlaceholder(Src);
+  bool DstIsPlaceholder = isPlaceholder(Dst);
+  if (SrcIsPlaceholder && DstIsPlaceholder) {
+    return;
+  }
+  if (SrcIsPlaceholder || DstIsPlaceholder) {
+    External[find(getNode(SrcIsPlaceholder ? Dst : Src))] = true;
+    return;
+  }
+  uint32_t A = find(getNode(Src));
+  uint32_t B = find(getNode(Dst));
+  if (A == B) return;
+  // Link the younger root under the older one, so that components are
+  // numbered in the order of their first ValueInfo.
+  if (A > B) {
+    std::swap(A, B);
+  }
+  Parent[B] = A;
+  External[A] = External[A] || External[B];
+}
+
+void Components::finish() {
+  assert(!Finished);
+  std::vector<uint32_t> Numbers(Parent.size(), ~uint32_t(0));
+  std::vector<uint8_t> RootExternal;
+  RootExternal.swap(External);
+  for (uint32_t i = 0, End = Parent.size(); i != End; ++i) {
+    uint32_t Root = find(i);
+    if (Numbers[Root] == ~uint32_t(0)) {
+      Numbers[Root] = Sizes.size();
+      Sizes.push_back(0);
+      External.push_back(RootExternal[Root]);
+      Representatives.push_back(0);
+    }
+  }
+  for (DenseMap<const ValueInfo *, uint32_t>::iterator i = Nodes.begin(),
+                                                       End = Nodes.end();
+       i != End; ++i) {
+    uint32_t C = Numbers[find(i->second)];
+    ++Sizes[C];
+    const ValueInfo *&Rep = Representatives[C];
+    if (!Rep || (i->first->getValue() && !Rep->getValue()) ||
+        (i->first->getValue() && i->first->getId() < Rep->getId())) {
+      Rep = i->first;
+    }
+    i->second = C;
+  }
+  Parent.clear();
+  Finished = true;
+}
+
+uint32_t Components::getComponent(const ValueInfo *VI) const {
+  assert(Finished);
+  if (isPlaceholder(VI)) {
+    return NoComponent;
+  }
+  DenseMap<const ValueInfo *, uint32_t>::const_iterator i = Nodes.find(VI);
+  assert(i != Nodes.end());
+  return i->second;
+}
+
+void Components::print(raw_ostream &OS, unsigned MaxComponents) const {
+  assert(Finished);
+  std::vector<uint32_t> Order;
+  Order.reserve(Sizes.size());
+  for (uint32_t i = 0, End = Sizes.size(); i != End; ++i) {
+    Order.push_back(i);
+  }
+  std::stable_sort(Order.begin(), Order.end(), LargerComponent(this));
+  if (Order.size() > MaxComponents) {
+    Order.resize(MaxComponents);
+  }
+  OS << Sizes.size() << " components of " << Nodes.size() << " values\n";
+  for (std::vector<uint32_t>::const_iterator i = Order.begin(),
+                                             End = Order.end();
+       i != End; ++i) {
+    OS << "  component " << *i << ": " << Sizes[*i] << " values";
+    if (External[*i]) {
+      OS << ", external";
+    }
+    const Value *V = Representatives[*i]->getValue();
+    if (V) {
+      OS << ", e.g. ";
+      if (V->hasName()) {
+        OS << V->getName();
+      } else {
+        OS << "<unnamed>";
+      }
+      if (const Function *F = getFunction(V)) {
+        OS << " in " << F->getName();
+      }
+    }
+    OS << '\n';
+  }
+}
+
+}
+}
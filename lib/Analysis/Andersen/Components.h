@@ -0,0 +1,98 @@
+//===- Components.h - connected components of the constraints -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type for the decomposition of the ValueInfos into the
+// connected components of the relations between them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <cassert>
+#include <vector>
+
+namespace llvm {
+
+class raw_ostream;
+
+}
+
+namespace llvm {
+namespace andersen_internal {
+
+class ValueInfo;
+
+// Components order solving, tell which intermediate results can be released
+// once a component is solved, and feed statistics. They do not get storage of
+// their own and are not solved concurrently: the sets of every component can
+// take elements from the shared sets of the special VIs, and enumeration is
+// not thread-safe, so all components live in the same Data.
+class Components {
+  // The special VIs for external regions relate to nearly everything, so they
+  // do not join components. Components related to them are marked external
+  // instead, since their sets can contain regions from other components by way
+  // of them.
+  const ValueInfo *const ExternallyLinkableRegions;
+  const ValueInfo *const ExternallyAccessibleRegions;
+  DenseMap<const ValueInfo *, uint32_t> Nodes;
+  // Union-find forest while adding relations; after finish(), the component of
+  // each node.
+  std::vector<uint32_t> Parent;
+  // Per root while adding relations; after finish(), per component.
+  std::vector<uint8_t> External;
+  std::vector<uint32_t> Sizes;
+  // The first ValueInfo of each component, for printing.
+  std::vector<const ValueInfo *> Representatives;
+  bool Finished;
+
+  bool isPlaceholder(const ValueInfo *VI) const {
+    return VI == ExternallyLinkableRegions ||
+           VI == ExternallyAccessibleRegions;
+  }
+
+  uint32_t getNode(const ValueInfo *VI);
+  uint32_t find(uint32_t N);
+
+public:
+  Components(const ValueInfo *ExternallyLinkableRegions,
+             const ValueInfo *ExternallyAccessibleRegions);
+
+  void addValueInfo(const ValueInfo *VI);
+  void addRelation(const ValueInfo *Src, const ValueInfo *Dst);
+
+  // Number the components densely. No more ValueInfos or relations may be
+  // added afterwards.
+  void finish();
+
+  uint32_t getNumComponents() const {
+    assert(Finished);
+    return Sizes.size();
+  }
+
+  static const uint32_t NoComponent = ~uint32_t(0);
+
+  // The component of VI, or NoComponent for the special VIs.
+  uint32_t getComponent(const ValueInfo *VI) const;
+
+  uint32_t getSize(uint32_t C) const { return Sizes[C]; }
+
+  bool isExternal(uint32_t C) const { return External[C]; }
+
+  // Print the sizes of the largest MaxComponents components.
+  void print(raw_ostream &OS, unsigned MaxComponents) const;
+};
+
+}
+}
+
+#endif
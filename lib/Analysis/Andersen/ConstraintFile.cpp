@@ -0,0 +1,439 @@
+//===- ConstraintFile.cpp - binary file of the relations ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the reader and writer of constraint files, which hold the
+// relations recorded by instruction analysis and the names of the ValueInfos,
+// so that they can be solved without the IR.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstraintFile.h"
+
+#include "Data.h"
+#include "Phase.h"
+#include "PointsToAlgorithm.h"
+#include "RelationStore.h"
+#include "RelationType.h"
+#include "ValueInfo.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Analysis/AndersenConstraints.h"
+#include "llvm/Analysis/AndersenEnumerator.h"
+#include "llvm/IR/Constant.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalValue.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+// "ANDC" as a little-endian word.
+const uint32_t Magic = 0x43444e41;
+const uint32_t Version = 2;
+// Printed constants are cut to this many characters.
+const size_t MaxConstantNameSize = 64;
+
+void writeWord(raw_ostream &OS, uint32_t Word) {
+  char Bytes[4];
+  for (unsigned i = 0; i != 4; ++i) {
+    Bytes[i] = char(Word >> (8 * i));
+  }
+  OS.write(Bytes, 4);
+}
+
+class WordReader {
+  const char *Pos;
+  const char *End;
+
+public:
+  explicit WordReader(StringRef Buffer)
+    : Pos(Buffer.begin()), End(Buffer.end()) {}
+
+  bool read(uint32_t &Word) {
+    if (End - Pos < 4) {
+      return false;
+    }
+    Word = 0;
+    for (unsigned i = 0; i != 4; ++i) {
+      Word |= uint32_t((unsigned char)Pos[i]) << (8 * i);
+    }
+    Pos += 4;
+    return true;
+  }
+
+  bool read(uint32_t Size, StringRef &Bytes) {
+    if (uint32_t(End - Pos) < Size) {
+      return false;
+    }
+    Bytes = StringRef(Pos, Size);
+    Pos += Size;
+    return true;
+  }
+
+  size_t getNumWordsLeft() const { return (End - Pos) / 4; }
+
+  bool atEnd() const { return Pos == End; }
+};
+
+// Give VI the name Name unless it already has one. The first Value analyzed
+// as VI is named first where possible, matching ValueInfo::getValue().
+void setName(std::vector<std::string> &Names, const ValueInfo *VI,
+             const Twine &Name) {
+  if (!VI) {
+    return;
+  }
+  std::string &S = Names[VI->getId()];
+  if (S.empty()) {
+    S = Name.str();
+  }
+}
+
+// The VI of V if V is its first Value, else null.
+const ValueInfo *getOwnValueInfo(const Data &D, const Value *V) {
+  ValueInfo *VI;
+  if (!D.lookupValueInfo(V, VI) || !VI || VI->getValue() != V) {
+    return 0;
+  }
+  return VI;
+}
+
+void nameGlobal(const Data &D, const GlobalValue &G,
+                std::vector<std::string> &Names) {
+  setName(Names, getOwnValueInfo(D, &G), "@" + G.getName());
+  ValueInfoMap::const_iterator i = D.GlobalRegionInfos.find(&G);
+  if (i != D.GlobalRegionInfos.end()) {
+    // Only differs from the VI of G if G is overridable.
+    setName(Names, i->second.getPtr(), "@" + G.getName() + ".region");
+  }
+}
+
+void nameFunctionBody(const Data &D, const Function &F,
+                      std::vector<std::string> &Names) {
+  std::string Prefix = ("@" + F.getName() + ":").str();
+  unsigned ArgNo = 0;
+  for (Function::const_arg_iterator i = F.arg_begin(), End = F.arg_end();
+       i != End; ++i, ++ArgNo) {
+    setName(Names, getOwnValueInfo(D, &*i),
+            i->hasName() ? Prefix + "%" + i->getName().str()
+                         : Prefix + "%arg" + utostr(ArgNo));
+  }
+  // Unnamed instructions are named by their position in F, which is also how
+  // the VIs of discarded bodies are kept.
+  FunctionBodyMap::const_iterator i = D.DematerializedValueInfos.find(&F);
+  if (i != D.DematerializedValueInfos.end()) {
+    for (size_t Pos = 0, End = i->second.size(); Pos != End; ++Pos) {
+      setName(Names, i->second[Pos].getPtr(), Prefix + "#" + utostr(Pos));
+    }
+    return;
+  }
+  size_t Pos = 0;
+  for (const_inst_iterator j = inst_begin(F), End = inst_end(F); j != End;
+       ++j, ++Pos) {
+    setName(Names, getOwnValueInfo(D, &*j),
+            j->hasName() ? Prefix + "%" + j->getName().str()
+                         : Prefix + "#" + utostr(Pos));
+  }
+}
+
+void nameConstants(const ValueInfoMap &Map, std::vector<std::string> &Names) {
+  for (ValueInfoMap::const_iterator i = Map.begin(), End = Map.end(); i != End;
+       ++i) {
+    const ValueInfo *VI = i->second.getPtr();
+    if (!VI || VI->getValue() != i->first || !isa<Constant>(i->first) ||
+        isa<GlobalValue>(i->first)) {
+      continue;
+    }
+    std::string Printed;
+    {
+      raw_string_ostream OS(Printed);
+      i->first->print(OS);
+    }
+    size_t Size = std::min(Printed.find('\n'), MaxConstantNameSize);
+    if (Size < Printed.size()) {
+      Printed.erase(Size);
+    }
+    setName(Names, VI, Printed);
+  }
+}
+
+void nameValueInfos(const Data &D, const Module &M,
+                    std::vector<std::string> &Names) {
+  setName(Names, D.ExternallyLinkableRegions.getPtr(),
+          "ExternallyLinkableRegions");
+  setName(Names, D.ExternallyAccessibleRegions.getPtr(),
+          "ExternallyAccessibleRegions");
+  for (Module::const_global_iterator i = M.global_begin(),
+                                     End = M.global_end();
+       i != End; ++i) {
+    nameGlobal(D, *i, Names);
+  }
+  for (Module::const_alias_iterator i = M.alias_begin(), End = M.alias_end();
+       i != End; ++i) {
+    nameGlobal(D, *i, Names);
+  }
+  for (Module::const_iterator i = M.begin(), End = M.end(); i != End; ++i) {
+    nameGlobal(D, *i, Names);
+    nameFunctionBody(D, *i, Names);
+  }
+  nameConstants(D.ValueInfos, Names);
+  nameConstants(D.InitializerValueInfos, Names);
+}
+
+}
+
+void ConstraintFile::write(const Data &D, const Module &M, raw_ostream &OS) {
+  assert(D.Relations && "Relations were not recorded");
+  const RelationStore &Store = *D.Relations;
+  uint32_t N = D.getNumValueInfos();
+  std::vector<std::string> Names(N);
+  nameValueInfos(D, M, Names);
+
+  // The (source, destination) pairs of each type of relation.
+  std::vector<uint32_t> Pairs[NumRelationTypes];
+  SmallVector<uint32_t, 8> Late;
+  for (unsigned RT = 0; RT != NumRelationTypes; ++RT) {
+    for (uint32_t Src = 0; Src != N; ++Src) {
+      ArrayRef<uint32_t> Dsts = Store.getDestinations(RelationType(RT), Src);
+      if (Store.hasLateRelations()) {
+        Late.clear();
+        Late.append(Dsts.begin(), Dsts.end());
+        Store.getLateDestinations(RelationType(RT), Src, Late);
+        Dsts = Late;
+      }
+      for (ArrayRef<uint32_t>::iterator i = Dsts.begin(), End = Dsts.end();
+           i != End; ++i) {
+        Pairs[RT].push_back(Src);
+        Pairs[RT].push_back(*i);
+      }
+    }
+  }
+
+  // Only the ids that appear in the file are numbered, so that the reader can
+  // bound their number by its size.
+  std::vector<bool> Used(N);
+  Used[D.ExternallyLinkableRegions->getId()] = true;
+  Used[D.ExternallyAccessibleRegions->getId()] = true;
+  for (uint32_t Id = 0; Id != N; ++Id) {
+    if (!Names[Id].empty() || Store.isRegion(Id)) {
+      Used[Id] = true;
+    }
+  }
+  for (unsigned RT = 0; RT != NumRelationTypes; ++RT) {
+    for (std::vector<uint32_t>::const_iterator i = Pairs[RT].begin(),
+                                               End = Pairs[RT].end();
+         i != End; ++i) {
+      Used[*i] = true;
+    }
+  }
+  std::vector<uint32_t> FileIds(N);
+  uint32_t NumFileIds = 0;
+  for (uint32_t Id = 0; Id != N; ++Id) {
+    if (Used[Id]) {
+      FileIds[Id] = NumFileIds++;
+    }
+  }
+
+  writeWord(OS, Magic);
+  writeWord(OS, Version);
+  writeWord(OS, NumFileIds);
+  writeWord(OS, FileIds[D.ExternallyLinkableRegions->getId()]);
+  writeWord(OS, FileIds[D.ExternallyAccessibleRegions->getId()]);
+
+  writeWord(OS, N - std::count(Names.begin(), Names.end(), std::string()));
+  for (uint32_t Id = 0; Id != N; ++Id) {
+    if (!Names[Id].empty()) {
+      writeWord(OS, FileIds[Id]);
+      writeWord(OS, Names[Id].size());
+      OS << Names[Id];
+    }
+  }
+
+  std::vector<uint32_t> Ids;
+  for (uint32_t Id = 0; Id != N; ++Id) {
+    if (Store.isRegion(Id)) {
+      Ids.push_back(FileIds[Id]);
+    }
+  }
+  writeWord(OS, Ids.size());
+  for (std::vector<uint32_t>::const_iterator i = Ids.begin(), End = Ids.end();
+       i != End; ++i) {
+    writeWord(OS, *i);
+  }
+
+  for (unsigned RT = 0; RT != NumRelationTypes; ++RT) {
+    writeWord(OS, Pairs[RT].size() / 2);
+    for (std::vector<uint32_t>::const_iterator i = Pairs[RT].begin(),
+                                               End = Pairs[RT].end();
+         i != End; ++i) {
+      writeWord(OS, FileIds[*i]);
+    }
+  }
+}
+
+Data *ConstraintFile::read(StringRef Buffer, std::vector<std::string> &Names,
+                           std::vector<ValueInfo *> &ValueInfos,
+                           std::string &ErrorInfo) {
+  WordReader R(Buffer);
+  uint32_t Word;
+  if (!R.read(Word) || Word != Magic) {
+    ErrorInfo = "not a constraint file";
+    return 0;
+  }
+  if (!R.read(Word) || Word != Version) {
+    ErrorInfo = "unsupported constraint file version";
+    return 0;
+  }
+  uint32_t N, ELRId, EARId;
+  if (!R.read(N) || !R.read(ELRId) || !R.read(EARId) || ELRId >= N ||
+      EARId >= N || ELRId == EARId) {
+    ErrorInfo = "invalid constraint file header";
+    return 0;
+  }
+  // Every id but those two appears in at least one of the remaining words.
+  if (N - 2 > R.getNumWordsLeft()) {
+    ErrorInfo = "more ids than the constraint file can hold";
+    return 0;
+  }
+
+  OwningPtr<Data> D(new Data());
+  ValueInfos.assign(N, 0);
+  for (uint32_t Id = 0; Id != N; ++Id) {
+    if (Id == ELRId) {
+      ValueInfos[Id] = D->ExternallyLinkableRegions.getPtr();
+    } else if (Id == EARId) {
+      ValueInfos[Id] = D->ExternallyAccessibleRegions.getPtr();
+    } else {
+      ValueInfos[Id] = D->createValueInfo(0);
+      D->AnonymousValueInfos.push_back(ValueInfos[Id]);
+    }
+  }
+
+  Names.assign(N, std::string());
+  uint32_t Count;
+  if (!R.read(Count)) {
+    ErrorInfo = "truncated constraint file";
+    return 0;
+  }
+  for (uint32_t i = 0; i != Count; ++i) {
+    uint32_t Id, Size;
+    StringRef Name;
+    if (!R.read(Id) || !R.read(Size) || !R.read(Size, Name)) {
+      ErrorInfo = "truncated constraint file";
+      return 0;
+    }
+    if (Id >= N) {
+      ErrorInfo = "invalid id in constraint file";
+      return 0;
+    }
+    Names[Id] = Name;
+  }
+
+  D->Relations = new RelationStore();
+  if (!R.read(Count)) {
+    ErrorInfo = "truncated constraint file";
+    return 0;
+  }
+  for (uint32_t i = 0; i != Count; ++i) {
+    uint32_t Id;
+    if (!R.read(Id)) {
+      ErrorInfo = "truncated constraint file";
+      return 0;
+    }
+    if (Id >= N) {
+      ErrorInfo = "invalid id in constraint file";
+      return 0;
+    }
+    D->Relations->addRegion(ValueInfos[Id]);
+  }
+  for (unsigned RT = 0; RT != NumRelationTypes; ++RT) {
+    if (!R.read(Count)) {
+      ErrorInfo = "truncated constraint file";
+      return 0;
+    }
+    for (uint32_t i = 0; i != Count; ++i) {
+      uint32_t Src, Dst;
+      if (!R.read(Src) || !R.read(Dst)) {
+        ErrorInfo = "truncated constraint file";
+        return 0;
+      }
+      if (Src >= N || Dst >= N) {
+        ErrorInfo = "invalid id in constraint file";
+        return 0;
+      }
+      D->Relations->addRelation(RelationType(RT), ValueInfos[Src],
+                                ValueInfos[Dst]);
+    }
+  }
+  if (!R.atEnd()) {
+    ErrorInfo = "trailing data in constraint file";
+    return 0;
+  }
+  D->finishRelations();
+  return D.take();
+}
+
+}
+}
+
+namespace llvm {
+
+using namespace andersen_internal;
+
+bool solveAndersenConstraints(StringRef Buffer, raw_ostream &OS,
+                              std::string &ErrorInfo) {
+  std::vector<std::string> Names;
+  std::vector<ValueInfo *> ValueInfos;
+  OwningPtr<Data> D(ConstraintFile::read(Buffer, Names, ValueInfos,
+                                         ErrorInfo));
+  if (!D) {
+    return false;
+  }
+  std::vector<uint32_t> FileIds(D->getNumValueInfos());
+  for (uint32_t Id = 0, End = ValueInfos.size(); Id != End; ++Id) {
+    FileIds[ValueInfos[Id]->getId()] = Id;
+  }
+  std::vector<uint32_t> Set;
+  for (uint32_t Id = 0, End = ValueInfos.size(); Id != End; ++Id) {
+    if (Names[Id].empty()) continue;
+    Set.clear();
+    AnalysisResult *AR = ValueInfos[Id]->getAlgorithmResult<
+        PointsToAlgorithm, ENUMERATION_PHASE>();
+    if (AR) {
+      for (AndersenEnumerator AE(AR);
+           ValueInfo *VI = AE.enumerate(); ) {
+        Set.push_back(FileIds[VI->getId()]);
+      }
+    }
+    // Ids rather than the enumeration order, so that solver changes can be
+    // diffed.
+    std::sort(Set.begin(), Set.end());
+    OS << '#' << Id << ' ' << Names[Id] << " = {";
+    for (std::vector<uint32_t>::const_iterator i = Set.begin(),
+                                               SetEnd = Set.end();
+         i != SetEnd; ++i) {
+      OS << (i == Set.begin() ? " #" : ", #") << *i;
+      if (!Names[*i].empty()) {
+        OS << ' ' << Names[*i];
+      }
+    }
+    OS << " }\n";
+  }
+  return true;
+}
+
+}
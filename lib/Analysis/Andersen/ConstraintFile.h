@@ -0,0 +1,68 @@
+//===- ConstraintFile.h - binary file of the relations --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the reader and writer of constraint files, which hold the
+// relations recorded by instruction analysis and the names of the ValueInfos,
+// so that they can be solved without the IR.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CONSTRAINTFILE_H
+#define CONSTRAINTFILE_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class Module;
+class raw_ostream;
+
+}
+
+namespace llvm {
+namespace andersen_internal {
+
+class Data;
+class ValueInfo;
+
+// The file is a sequence of little-endian 32-bit words, except for the bytes
+// of the names:
+//
+//   magic, version, number of ids, id of ExternallyLinkableRegions, id of
+//   ExternallyAccessibleRegions,
+//   number of names, then (id, length, bytes) for each,
+//   number of regions, then their ids,
+//   for each RelationType in order: number of relations, then (source id,
+//   destination id) for each.
+//
+// Ids are dense, and each one but the first two listed appears again later,
+// so a file of W words has fewer than W + 2 ids.
+class ConstraintFile {
+public:
+  // Write the relations of D, which must have been recorded in a
+  // RelationStore, naming the VIs after the Values of M they stand for.
+  static void write(const Data &D, const Module &M, raw_ostream &OS);
+
+  // Read a file written by write() into a new Data whose relations are ready
+  // to be solved. Names and ValueInfos receive the names and the new VIs by
+  // their id in the file, with empty names for VIs that have none. Returns null
+  // and sets ErrorInfo if Buffer is not a valid constraint file.
+  static Data *read(StringRef Buffer, std::vector<std::string> &Names,
+                    std::vector<ValueInfo *> &ValueInfos,
+                    std::string &ErrorInfo);
+};
+
+}
+}
+
+#endif
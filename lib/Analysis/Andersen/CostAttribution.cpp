@@ -0,0 +1,188 @@
+//===- CostAttribution.cpp - solver work by originating function ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type that tags the relations produced by instruction
+// analysis with the function they came from, and charges the enumeration work
+// done for them back to that function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CostAttribution.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+// Orders origin indices by the work charged to them, most first.
+class ByCost {
+  const std::vector<uint64_t> &Costs;
+
+public:
+  explicit ByCost(const std::vector<uint64_t> &Costs) : Costs(Costs) {}
+
+  bool operator()(unsigned A, unsigned B) const {
+    if (Costs[A] != Costs[B]) {
+      return Costs[A] > Costs[B];
+    }
+    return A < B;
+  }
+};
+
+void printRow(uint64_t Elements, uint64_t Transforms, StringRef Name,
+              raw_ostream &OS) {
+  OS << format("%12llu %12llu %12llu  ", (unsigned long long)Elements,
+               (unsigned long long)Transforms,
+               (unsigned long long)(Elements + Transforms))
+     << Name << '\n';
+}
+
+}
+
+CostAttribution *CostAttribution::Active = 0;
+
+CostAttribution::CostAttribution()
+  : Current(NoOrigin), UnattributedElements(0), UnattributedTransforms(0) {
+  assert(!Active);
+  Active = this;
+  Origin NoFunction = { "<globals and external code>", 0, 0 };
+  Origins.push_back(NoFunction);
+}
+
+CostAttribution::~CostAttribution() {
+  assert(Active == this);
+  Active = 0;
+}
+
+unsigned CostAttribution::getOrigin(const AnalysisResult *AR,
+                                    const AnalysisResult *Subset) const {
+  DenseMap<SubsetKey, unsigned>::const_iterator i =
+      Subsets.find(SubsetKey(AR, Subset));
+  if (i != Subsets.end()) {
+    return i->second;
+  }
+  DenseMap<const AnalysisResult *, unsigned>::const_iterator j =
+      Results.find(AR);
+  return j != Results.end() ? j->second : NoOrigin;
+}
+
+void CostAttribution::tagRelation(RelationType RT, const ValueInfo *Src,
+                                  const ValueInfo *Dst, const Function *F) {
+  unsigned Index = 0;
+  if (F) {
+    std::pair<DenseMap<const Function *, unsigned>::iterator, bool> Inserted =
+        FunctionOrigins.insert(std::make_pair(F, unsigned(Origins.size())));
+    Index = Inserted.first->second;
+    if (Inserted.second) {
+      Origin O = { F->getName().str(), 0, 0 };
+      Origins.push_back(O);
+    }
+  }
+  Relations.insert(std::make_pair(
+      RelationKey(std::make_pair(Src, Dst), unsigned(RT)), Index));
+  // Without a relation store, the relation becomes work right away.
+  Current = Index;
+}
+
+void CostAttribution::setCurrentRelation(RelationType RT, const ValueInfo *Src,
+                                         const ValueInfo *Dst) {
+  DenseMap<RelationKey, unsigned>::const_iterator i = Relations.find(
+      RelationKey(std::make_pair(Src, Dst), unsigned(RT)));
+  Current = i != Relations.end() ? i->second : NoOrigin;
+}
+
+void CostAttribution::addSubset(const AnalysisResult *AR,
+                                const AnalysisResult *Subset,
+                                unsigned Origin) {
+  if (Origin == NoOrigin) {
+    return;
+  }
+  // Keep the first origin. Later ones only add the same subset again.
+  Subsets.insert(std::make_pair(SubsetKey(AR, Subset), Origin));
+  Results.insert(std::make_pair(Subset, Origin));
+}
+
+void CostAttribution::addElement(const AnalysisResult *AR,
+                                 const AnalysisResult *Subset) {
+  unsigned Index = getOrigin(AR, Subset);
+  if (Index == NoOrigin) {
+    ++UnattributedElements;
+  } else {
+    ++Origins[Index].Elements;
+  }
+}
+
+void CostAttribution::addTransform(const AnalysisResult *AR,
+                                   const AnalysisResult *Input,
+                                   const AnalysisResult *Result) {
+  unsigned Index = getOrigin(AR, Input);
+  if (Index == NoOrigin) {
+    ++UnattributedTransforms;
+    return;
+  }
+  ++Origins[Index].Transforms;
+  Subsets.insert(std::make_pair(SubsetKey(AR, Result), Index));
+  Results.insert(std::make_pair(Result, Index));
+}
+
+void CostAttribution::moveSubset(const AnalysisResult *AR,
+                                 const AnalysisResult *From,
+                                 const AnalysisResult *NewAR,
+                                 const AnalysisResult *To) {
+  unsigned Index = getOrigin(AR, From);
+  if (Index != NoOrigin) {
+    Subsets.insert(std::make_pair(SubsetKey(NewAR, To), Index));
+  }
+}
+
+void CostAttribution::print(raw_ostream &OS, unsigned MaxFunctions) const {
+  std::vector<uint64_t> Costs;
+  std::vector<unsigned> Ranked;
+  uint64_t TotalElements = UnattributedElements;
+  uint64_t TotalTransforms = UnattributedTransforms;
+  for (unsigned i = 0, End = Origins.size(); i != End; ++i) {
+    const Origin &O = Origins[i];
+    Costs.push_back(O.Elements + O.Transforms);
+    if (Costs.back()) {
+      Ranked.push_back(i);
+    }
+    TotalElements += O.Elements;
+    TotalTransforms += O.Transforms;
+  }
+  std::sort(Ranked.begin(), Ranked.end(), ByCost(Costs));
+
+  OS << "Enumeration work induced by the relations of each function\n";
+  OS << "    elements   transforms        total  function\n";
+  size_t N = Ranked.size();
+  if (MaxFunctions && MaxFunctions < N) {
+    N = MaxFunctions;
+  }
+  for (size_t i = 0; i != N; ++i) {
+    const Origin &O = Origins[Ranked[i]];
+    printRow(O.Elements, O.Transforms, O.Name, OS);
+  }
+  if (N != Ranked.size()) {
+    OS << "  ... " << Ranked.size() - N << " more\n";
+  }
+  if (UnattributedElements || UnattributedTransforms) {
+    printRow(UnattributedElements, UnattributedTransforms, "<unattributed>",
+             OS);
+  }
+  printRow(TotalElements, TotalTransforms, "<total>", OS);
+}
+
+}
+}
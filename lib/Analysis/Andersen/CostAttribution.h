@@ -0,0 +1,125 @@
+//===- CostAttribution.h - solver work by originating function ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type that tags the relations produced by instruction
+// analysis with the function they came from, and charges the enumeration work
+// done for them back to that function.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COSTATTRIBUTION_H
+#define COSTATTRIBUTION_H
+
+#include "RelationType.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+class Function;
+class raw_ostream;
+
+}
+
+namespace llvm {
+namespace andersen_internal {
+
+class AnalysisResult;
+class ValueInfo;
+
+// Only one can be recording at a time. While none is, the hooks in instruction
+// analysis and enumeration cost a single test.
+//
+// The work an AR does to read a subset is charged to the function whose
+// relation added the subset. Subsets added by transforms, and the work of ARs
+// created to be such subsets, inherit the function of the work that led to
+// them.
+class CostAttribution {
+  struct Origin {
+    // Copied, since the function may be gone by the time of the report.
+    std::string Name;
+    uint64_t Elements;
+    uint64_t Transforms;
+  };
+
+  typedef std::pair<std::pair<const ValueInfo *, const ValueInfo *>, unsigned>
+      RelationKey;
+  typedef std::pair<const AnalysisResult *, const AnalysisResult *> SubsetKey;
+
+  // Index 0 is for the relations that belong to no function, such as those of
+  // global initializers and of the regions of external code.
+  std::vector<Origin> Origins;
+  DenseMap<const Function *, unsigned> FunctionOrigins;
+  // The origin of each relation, by the first function that produced it.
+  DenseMap<RelationKey, unsigned> Relations;
+  // The origin of each subset of each AR.
+  DenseMap<SubsetKey, unsigned> Subsets;
+  // The origin of the work of ARs first created as some subset.
+  DenseMap<const AnalysisResult *, unsigned> Results;
+  // The origin of the relation being turned into work.
+  unsigned Current;
+  uint64_t UnattributedElements;
+  uint64_t UnattributedTransforms;
+
+  static CostAttribution *Active;
+
+  static const unsigned NoOrigin = ~0U;
+
+  unsigned getOrigin(const AnalysisResult *AR,
+                     const AnalysisResult *Subset) const;
+
+public:
+  // Starts recording.
+  CostAttribution();
+  // Stops recording.
+  ~CostAttribution();
+
+  static CostAttribution *getActive() { return Active; }
+
+  // Instruction analysis of F, or of no function if F is null, produced the
+  // relation.
+  void tagRelation(RelationType RT, const ValueInfo *Src, const ValueInfo *Dst,
+                   const Function *F);
+
+  // The work added next comes from the relation.
+  void setCurrentRelation(RelationType RT, const ValueInfo *Src,
+                          const ValueInfo *Dst);
+
+  // The origin of the relation being turned into work. Creating the ARs for it
+  // can turn other relations into work first, so read it before that.
+  unsigned getCurrentOrigin() const { return Current; }
+
+  // The relation of the given origin made Subset a subset of AR.
+  void addSubset(const AnalysisResult *AR, const AnalysisResult *Subset,
+                 unsigned Origin);
+
+  // AR got an element by reading its subset Subset.
+  void addElement(const AnalysisResult *AR, const AnalysisResult *Subset);
+
+  // AR got the subset Result from a transform of an element of Input.
+  void addTransform(const AnalysisResult *AR, const AnalysisResult *Input,
+                    const AnalysisResult *Result);
+
+  // The subset From of AR is now read as the subset To of NewAR.
+  void moveSubset(const AnalysisResult *AR, const AnalysisResult *From,
+                  const AnalysisResult *NewAR, const AnalysisResult *To);
+
+  // Print the functions by the work charged to them, most first. MaxFunctions
+  // limits the number printed if nonzero.
+  void print(raw_ostream &OS, unsigned MaxFunctions) const;
+};
+
+}
+}
+
+#endif
@@ -11,23 +11,82 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "andersen"
 #include "Data.h"
 
+#include "AliasClasses.h"
+#include "Components.h"
 #include "DebugInfo.h"
+#include "Derivations.h"
+#include "EnumerationSession.h"
+#include "FinishedSet.h"
+#include "Phase.h"
+#include "PointsToAlgorithm.h"
+#include "RelationStore.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AndersenEnumerator.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/InstIterator.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 namespace llvm {
 namespace andersen_internal {
 
+STATISTIC(NumElementsEvicted,
+          "Number of set elements discarded under memory pressure");
+STATISTIC(NumElementsReleased,
+          "Number of set elements discarded once their component was solved");
+STATISTIC(NumTransformsShared,
+          "Number of transform results replaced by an identical one");
+
 namespace {
 
+// Rough cost of one set element: a vector slot plus a hash table bucket with
+// its slack.
+const size_t BytesPerSetElement = 32;
+
+struct EvictArg {
+  DenseSet<AnalysisResult *> Inputs;
+  size_t Released;
+
+  EvictArg() : Released(0) {}
+};
+
+// Look through chains of ARs that are only the whole of another AR. The chain
+// length is bounded so that cycles of them terminate.
+AnalysisResult *getCanonicalInput(AnalysisResult *AR) {
+  for (unsigned Steps = 0; Steps != 64; ++Steps) {
+    AnalysisResult *Next = AR->getWholeSubset();
+    if (!Next) break;
+    AR = Next;
+  }
+  return AR;
+}
+
+void collectPendingInputsVisitor(void *Arg, ValueInfo *VI) {
+  VI->collectPendingInputs(static_cast<EvictArg *>(Arg)->Inputs);
+}
+
+void evictVisitor(void *Arg, ValueInfo *VI) {
+  EvictArg *EA = static_cast<EvictArg *>(Arg);
+  EA->Released += VI->evictIntermediateResults(EA->Inputs);
+}
+
 void getOutgoingEdgesVisitor(void *Arg, ValueInfo *VI) {
-  GraphEdgeDeque *Result = static_cast<GraphEdgeDeque *>(Arg);
+  GraphEdgeVector *Edges = static_cast<GraphEdgeVector *>(Arg);
   // No edge label needed because the edges will not be printed.
-  Result->push_back(GraphEdge(VI, std::string()));
+  Edges->push_back(GraphEdge(VI, GraphEdge::NONE));
 }
 
 struct WriteEquationsArg {
@@ -49,17 +108,342 @@ void writeEquationsVisitor(void *Arg, ValueInfo *VI) {
 
 }
 
-Data::Data(ValueInfo *ExternallyLinkableRegions,
-           ValueInfo *ExternallyAccessibleRegions)
-  : ExternallyLinkableRegions(ExternallyLinkableRegions),
-    ExternallyAccessibleRegions(ExternallyAccessibleRegions) {}
+Data::Data()
+  : NumAnalysisResults(0),
+    NumSetElements(0),
+    Universe(0),
+    NumUniverseHolders(0),
+    NextSweepBytes(0),
+    ExternallyLinkableRegions(createValueInfo(0)),
+    ExternallyAccessibleRegions(createValueInfo(0)),
+    Classes(0),
+    Comps(0),
+    Relations(0),
+    Derivs(0),
+    Solver(0) {
+  addAnalysisResult(&EmptyAnalysisResult);
+}
+
+Data::~Data() {
+  DeleteContainerSeconds(UniverseTransforms);
+  DeleteContainerSeconds(SetCopies);
+  delete Classes;
+  delete Comps;
+  delete Relations;
+  delete Derivs;
+}
+
+const FinishedSet *Data::getFinishedSet(AnalysisResult *AR,
+                                        EnumerationSession *Session) {
+  assert(AR->isDone());
+  // Sets that hold the universe by its flag contain it. Of the others, every
+  // superset of the universe contains ExternallyLinkableRegions, so only those
+  // sets are worth checking.
+  AnalysisResult *UniverseAR = ExternallyAccessibleRegions->getAlgorithmResult<
+      PointsToAlgorithm, ENUMERATION_PHASE>();
+  if (!UniverseAR || AR == UniverseAR ||
+      (!AR->containsUniverse() &&
+       !AR->getSetContentsSoFar().count(ExternallyLinkableRegions->getId()))) {
+    return &AR->getFinishedSet(getNumValueInfos());
+  }
+  if (!UniverseAR->isDone()) {
+    for (AndersenEnumerator AE(UniverseAR,
+                               UniverseAR->getSetContentsSoFar().size());
+         AE.enumerate(Session); );
+    if (Session && Session->isSuspended()) {
+      return 0;
+    }
+    assert(UniverseAR->isDone());
+  }
+  return &AR->getFinishedSet(getNumValueInfos(),
+                             &UniverseAR->getFinishedSet(getNumValueInfos()));
+}
+
+const ValueInfoSetVector &Data::getSetCopy(const AnalysisResult *AR) {
+  SetCopy *&Copy = SetCopies[AR];
+  if (!Copy) {
+    Copy = new SetCopy();
+  }
+  if (Copy->Final) {
+    return Copy->Set;
+  }
+  // Until AR is done the copy holds just the elements it lists, which only
+  // grow at the end.
+  const ValueInfoIdSetVector &Ids = AR->getSetContentsSoFar();
+  for (size_t i = Copy->Set.size(), End = Ids.size(); i < End; ++i) {
+    Copy->Set.insert(getValueInfo(Ids[i]));
+  }
+  if (!AR->isDone()) {
+    return Copy->Set;
+  }
+  // Then those of the universe, if AR holds it, apart from those it lists
+  // itself. The universe may still grow if it is not done.
+  if (AR->containsUniverse()) {
+    const ValueInfoIdSetVector &UniverseIds = Universe->getSetContentsSoFar();
+    for (size_t i = 0, End = UniverseIds.size(); i != End; ++i) {
+      Copy->Set.insert(getValueInfo(UniverseIds[i]));
+    }
+  }
+  Copy->Final = !AR->containsUniverse() || Universe->isDone();
+  return Copy->Set;
+}
+
+void Data::getSolveOrder(ArrayRef<AnalysisResult *> Roots,
+                         std::vector<AnalysisResult *> &Order) const {
+  // Iterative depth-first search over the inputs of pending work.
+  DenseSet<AnalysisResult *> Visited;
+  std::vector<std::pair<AnalysisResult *, size_t> > Stack;
+  for (ArrayRef<AnalysisResult *>::iterator i = Roots.begin(),
+                                            End = Roots.end();
+       i != End; ++i) {
+    if (!*i || (*i)->isDone() || !Visited.insert(*i).second) continue;
+    Stack.push_back(std::make_pair(*i, size_t(0)));
+    while (!Stack.empty()) {
+      AnalysisResult *AR = Stack.back().first;
+      size_t &Next = Stack.back().second;
+      if (Next == AR->Work.size()) {
+        Order.push_back(AR);
+        Stack.pop_back();
+        continue;
+      }
+      AnalysisResult *Input = AR->Work[Next++].getInput();
+      if (Input && !Input->isDone() && Visited.insert(Input).second) {
+        Stack.push_back(std::make_pair(Input, size_t(0)));
+      }
+    }
+  }
+}
+
+void Data::renumber() {
+  assert(!Relations && "Relations refer to the VIs by id");
+  assert(UniverseTransforms.empty() && "Enumeration has started");
+  // The owner of each AR, and the roots of the traversal in order: the
+  // points-to set of each VI first, then everything else.
+  DenseMap<AnalysisResult *, ValueInfo *> Owners;
+  std::vector<AnalysisResult *> Roots;
+  for (ValueInfoVector::const_iterator i = ValueInfosById.begin(),
+                                       End = ValueInfosById.end();
+       i != End; ++i) {
+    ValueInfo *VI = i->getPtr();
+    if (AnalysisResult *AR = VI->getAlgorithmResultOrNull(
+            &PointsToAlgorithm::ID)) {
+      Roots.push_back(AR);
+    }
+    for (ValueInfo::ResultsMapTy::const_iterator j = VI->Results.begin(),
+                                                 JEnd = VI->Results.end();
+         j != JEnd; ++j) {
+      Owners.insert(std::make_pair(j->second, VI));
+    }
+  }
+  for (ValueInfoVector::const_iterator i = ValueInfosById.begin(),
+                                       End = ValueInfosById.end();
+       i != End; ++i) {
+    for (ValueInfo::ResultsMapTy::const_iterator j = (*i)->Results.begin(),
+                                                 JEnd = (*i)->Results.end();
+         j != JEnd; ++j) {
+      Roots.push_back(j->second);
+    }
+  }
+
+  // Iterative depth-first search over the inputs of pending work.
+  std::vector<AnalysisResult *> PostOrder;
+  PostOrder.reserve(Owners.size());
+  DenseSet<AnalysisResult *> Visited;
+  std::vector<std::pair<AnalysisResult *, size_t> > Stack;
+  for (std::vector<AnalysisResult *>::const_iterator i = Roots.begin(),
+                                                     End = Roots.end();
+       i != End; ++i) {
+    if (!Visited.insert(*i).second) continue;
+    Stack.push_back(std::make_pair(*i, size_t(0)));
+    while (!Stack.empty()) {
+      AnalysisResult *AR = Stack.back().first;
+      size_t &Next = Stack.back().second;
+      if (Next == AR->Work.size()) {
+        PostOrder.push_back(AR);
+        Stack.pop_back();
+        continue;
+      }
+      AnalysisResult *Input = AR->Work[Next++].getInput();
+      // Skip ARs not owned by a VI, like EmptyAnalysisResult.
+      if (Input && Owners.count(Input) && Visited.insert(Input).second) {
+        Stack.push_back(std::make_pair(Input, size_t(0)));
+      }
+    }
+  }
 
-Data::~Data() {}
+  // Renumber the VIs in the order that their results and the elements of
+  // those results are first reached. VIs that were not visited follow in their
+  // old order.
+  std::vector<ValueInfo *> NewOrder;
+  NewOrder.reserve(ValueInfosById.size());
+  DenseSet<ValueInfo *> Placed;
+  for (std::vector<AnalysisResult *>::const_reverse_iterator
+           i = PostOrder.rbegin(), End = PostOrder.rend();
+       i != End; ++i) {
+    ValueInfo *Owner = Owners.lookup(*i);
+    if (Placed.insert(Owner).second) {
+      NewOrder.push_back(Owner);
+    }
+    const ValueInfoIdSetVector &Set = (*i)->Set;
+    for (ValueInfoIdSetVector::const_iterator j = Set.begin(),
+                                              JEnd = Set.end();
+         j != JEnd; ++j) {
+      ValueInfo *VI = getValueInfo(*j);
+      if (Placed.insert(VI).second) {
+        NewOrder.push_back(VI);
+      }
+    }
+  }
+  for (ValueInfoVector::const_iterator i = ValueInfosById.begin(),
+                                       End = ValueInfosById.end();
+       i != End; ++i) {
+    if (Placed.insert(i->getPtr()).second) {
+      NewOrder.push_back(i->getPtr());
+    }
+  }
+  assert(NewOrder.size() == ValueInfosById.size());
+  std::vector<uint32_t> NewIds(NewOrder.size());
+  for (uint32_t i = 0, End = NewOrder.size(); i != End; ++i) {
+    NewIds[NewOrder[i]->Id] = i;
+  }
 
-GraphEdgeDeque Data::getOutgoingEdges() const {
-  GraphEdgeDeque Result;
-  visitValueInfos(&getOutgoingEdgesVisitor, static_cast<void *>(&Result));
-  return Result;
+  for (std::vector<AnalysisResult *>::const_iterator i = PostOrder.begin(),
+                                                     End = PostOrder.end();
+       i != End; ++i) {
+    (*i)->renumberElements(NewIds);
+  }
+
+  // Build the new table before dropping the old one, which may hold the only
+  // references to some VIs.
+  ValueInfoVector ById(NewOrder.begin(), NewOrder.end());
+  for (uint32_t i = 0, End = ById.size(); i != End; ++i) {
+    ById[i]->Id = i;
+  }
+  ValueInfosById.swap(ById);
+}
+
+void Data::shareTransformResults() {
+  assert(!Relations && "Most ARs are not built yet");
+  for (ValueInfoVector::const_iterator i = ValueInfosById.begin(),
+                                       End = ValueInfosById.end();
+       i != End; ++i) {
+    for (ValueInfo::ResultsMapTy::const_iterator j = (*i)->Results.begin(),
+                                                 JEnd = (*i)->Results.end();
+         j != JEnd; ++j) {
+      shareTransformResult(j->second);
+    }
+  }
+}
+
+void Data::shareTransformResult(AnalysisResult *AR) {
+  if (!AR->Set.empty() || AR->Work.size() != 1) return;
+  const AnalysisResultWork &Work = AR->Work.front();
+  if (Work.getKind() != AnalysisResultWork::TRANSFORM ||
+      Work.getPosition() != 0) {
+    return;
+  }
+  TransformKey Key(Work.getTransform(*this),
+                   getCanonicalInput(Work.getInput()));
+  std::pair<DenseMap<TransformKey, AnalysisResult *>::iterator, bool> P =
+      SharedTransforms.insert(std::make_pair(Key, AR));
+  if (P.second || P.first->second == AR) return;
+  AR->Work.clear();
+  if (AR->prepareForSubset(P.first->second)) {
+    AR->Work.push_back(AnalysisResultWork::makeSubset(P.first->second));
+  }
+  ++NumTransformsShared;
+}
+
+void Data::relieveMemoryPressure(size_t MaxBytes) {
+  size_t Bytes = NumSetElements * BytesPerSetElement;
+  if (Bytes <= std::max(MaxBytes, NextSweepBytes)) {
+    return;
+  }
+  // Results that pending work is still reading from must stay, since the
+  // recomputed contents may come in a different order.
+  EvictArg EA;
+  visitValueInfos(&collectPendingInputsVisitor, static_cast<void *>(&EA));
+  for (DenseMap<const TransformAlgorithm *, AnalysisResult *>::const_iterator
+           i = UniverseTransforms.begin(), End = UniverseTransforms.end();
+       i != End; ++i) {
+    i->second->collectInputs(EA.Inputs);
+  }
+  visitValueInfos(&evictVisitor, static_cast<void *>(&EA));
+  NumElementsEvicted += EA.Released;
+  Bytes = NumSetElements * BytesPerSetElement;
+  NextSweepBytes = Bytes + Bytes / 8;
+}
+
+void Data::releaseIntermediateResults(ArrayRef<ValueInfo *> VIs) {
+  // Only pending work within VIs can read their results.
+  DenseSet<AnalysisResult *> Inputs;
+  for (ArrayRef<ValueInfo *>::iterator i = VIs.begin(), End = VIs.end();
+       i != End; ++i) {
+    (*i)->collectPendingInputs(Inputs);
+  }
+  for (ArrayRef<ValueInfo *>::iterator i = VIs.begin(), End = VIs.end();
+       i != End; ++i) {
+    NumElementsReleased += (*i)->evictIntermediateResults(Inputs);
+  }
+}
+
+ValueInfo *Data::createValueInfo(const Value *V) {
+  assert(ValueInfosById.size() < ~uint32_t(0) - 1 && "Out of ids");
+  ValueInfo *VI = new ValueInfo(this, V, ValueInfosById.size());
+  ValueInfosById.push_back(VI);
+  return VI;
+}
+
+void Data::addAnalysisResult(const ValueInfo *VI, const AlgorithmId *Algorithm,
+                             AnalysisResult *AR) {
+  addAnalysisResult(AR);
+  if (VI == ExternallyAccessibleRegions.getPtr() &&
+      Algorithm == &PointsToAlgorithm::ID) {
+    assert(!Universe);
+    Universe = AR;
+  }
+}
+
+AnalysisResult *Data::getUniverseTransform(
+    const TransformAlgorithm *Transform) {
+  assert(Universe);
+  AnalysisResult *&AR = UniverseTransforms[Transform];
+  if (!AR) {
+    AR = new AnalysisResult();
+    addAnalysisResult(AR);
+    AR->appendUniqueTransform(*this, Transform, Universe);
+  }
+  return AR;
+}
+
+RelationStore *Data::getFinishedRelations() const {
+  return Relations && Relations->isFinished() ? Relations : 0;
+}
+
+uint32_t Data::getTransformIndex(const TransformAlgorithm *Transform) {
+  std::pair<DenseMap<const TransformAlgorithm *, uint32_t>::iterator, bool>
+      Inserted = TransformIndices.insert(
+          std::make_pair(Transform, uint32_t(Transforms.size())));
+  if (Inserted.second) {
+    Transforms.push_back(Transform);
+  }
+  return Inserted.first->second;
+}
+
+void Data::finishRelations() {
+  assert(Relations);
+  std::vector<ValueInfo *> VIs;
+  VIs.reserve(ValueInfosById.size());
+  for (ValueInfoVector::const_iterator i = ValueInfosById.begin(),
+                                       End = ValueInfosById.end();
+       i != End; ++i) {
+    VIs.push_back(i->getPtr());
+  }
+  Relations->finish(VIs);
+}
+
+void Data::getOutgoingEdges(const Data &D, GraphEdgeVector &Edges) const {
+  visitValueInfos(&getOutgoingEdgesVisitor, static_cast<void *>(&Edges));
 }
 
 void Data::printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const {
@@ -79,6 +463,11 @@ void Data::writeEquations(const DebugInfo &DI, raw_ostream &OS) const {
     WriteEquationsArg WEA(&DI, &OS);
     visitValueInfos(&writeEquationsVisitor, static_cast<void *>(&WEA));
   }
+  for (DenseMap<const TransformAlgorithm *, AnalysisResult *>::const_iterator
+           i = UniverseTransforms.begin(), End = UniverseTransforms.end();
+       i != End; ++i) {
+    i->second->writeEquation(DI, OS);
+  }
   // Also print all the equivalences.
   for (ValueInfoMap::const_iterator i = ValueInfos.begin(),
                                     End = ValueInfos.end();
@@ -95,6 +484,157 @@ void Data::writeEquations(const DebugInfo &DI, raw_ostream &OS) const {
   }
 }
 
+bool Data::lookupValueInfo(const Value *V, ValueInfo *&VI) const {
+  ValueInfoMap::const_iterator i = ValueInfos.find(V);
+  if (i != ValueInfos.end()) {
+    VI = i->second.getPtr();
+    return true;
+  }
+  i = InitializerValueInfos.find(V);
+  if (i != InitializerValueInfos.end()) {
+    VI = i->second.getPtr();
+    return true;
+  }
+  const Instruction *I = dyn_cast<Instruction>(V);
+  if (!I || DematerializedValueInfos.empty()) {
+    return false;
+  }
+  const Function *F = I->getParent()->getParent();
+  FunctionBodyMap::const_iterator j = DematerializedValueInfos.find(F);
+  if (j == DematerializedValueInfos.end()) {
+    return false;
+  }
+  size_t Position;
+  if (!getDematerializedPosition(I, Position)) {
+    return false;
+  }
+  const ValueInfoVector &Body = j->second;
+  // Trailing instructions that point to nothing are not stored.
+  VI = Position < Body.size() ? Body[Position].getPtr() : 0;
+  return true;
+}
+
+bool Data::isInChangedBody(const Value *V) const {
+  const Instruction *I = dyn_cast<Instruction>(V);
+  if (!I || !DematerializedOpcodes.count(I->getParent()->getParent())) {
+    return false;
+  }
+  size_t Position;
+  return !getDematerializedPosition(I, Position);
+}
+
+bool Data::getDematerializedPosition(const Instruction *I,
+                                     size_t &Position) const {
+  const Function *F = I->getParent()->getParent();
+  FunctionOpcodeMap::const_iterator i = DematerializedOpcodes.find(F);
+  assert(i != DematerializedOpcodes.end());
+  const std::vector<uint8_t> &Opcodes = i->second;
+  // Linear in the size of F, but only instructions of bodies read in again
+  // after analysis get here. Passes may have changed the body since, so the
+  // position only means the same instruction if every opcode still matches.
+  size_t NumInstructions = 0;
+  for (const_inst_iterator j = inst_begin(F), End = inst_end(F); j != End;
+       ++j, ++NumInstructions) {
+    if (NumInstructions == Opcodes.size() ||
+        j->getOpcode() != Opcodes[NumInstructions]) {
+      return false;
+    }
+    if (&*j == I) {
+      Position = NumInstructions;
+    }
+  }
+  return NumInstructions == Opcodes.size();
+}
+
+ValueInfo *Data::findValueInfo(const Module &M, StringRef Name) const {
+  if (!Name.startswith("@")) {
+    return 0;
+  }
+  std::pair<StringRef, StringRef> Parts = Name.substr(1).split(':');
+  ValueInfo *VI = 0;
+  if (Parts.second.empty()) {
+    if (const GlobalValue *G = M.getNamedValue(Parts.first)) {
+      return lookupValueInfo(G, VI) ? VI : 0;
+    }
+    // The region of an overridable global.
+    StringRef Suffix(".region");
+    if (!Parts.first.endswith(Suffix)) {
+      return 0;
+    }
+    const GlobalValue *G =
+        M.getNamedValue(Parts.first.drop_back(Suffix.size()));
+    if (!G) {
+      return 0;
+    }
+    ValueInfoMap::const_iterator i = GlobalRegionInfos.find(G);
+    return i != GlobalRegionInfos.end() ? i->second.getPtr() : 0;
+  }
+  const Function *F = M.getFunction(Parts.first);
+  if (!F) {
+    return 0;
+  }
+  StringRef Local = Parts.second;
+  if (Local.startswith("%")) {
+    const Value *V = F->getValueSymbolTable().lookup(Local.substr(1));
+    unsigned ArgNo;
+    if (!V && Local.startswith("%arg") &&
+        !Local.substr(4).getAsInteger(10, ArgNo) && ArgNo < F->arg_size()) {
+      Function::const_arg_iterator A = F->arg_begin();
+      std::advance(A, ArgNo);
+      V = A;
+    }
+    if (!V || !lookupValueInfo(V, VI)) {
+      return 0;
+    }
+    return VI;
+  }
+  size_t Pos;
+  if (!Local.startswith("#") || Local.substr(1).getAsInteger(10, Pos)) {
+    return 0;
+  }
+  FunctionBodyMap::const_iterator Body = DematerializedValueInfos.find(F);
+  if (Body != DematerializedValueInfos.end()) {
+    return Pos < Body->second.size() ? Body->second[Pos].getPtr() : 0;
+  }
+  for (const_inst_iterator i = inst_begin(F), End = inst_end(F); i != End;
+       ++i, --Pos) {
+    if (!Pos) {
+      return lookupValueInfo(&*i, VI) ? VI : 0;
+    }
+  }
+  return 0;
+}
+
+void Data::forgetFunctionBody(const Function &F) {
+  ValueInfoVector &Body = DematerializedValueInfos[&F];
+  assert(Body.empty() && "Function body forgotten twice");
+  std::vector<uint8_t> &Opcodes = DematerializedOpcodes[&F];
+  for (const_inst_iterator i = inst_begin(F), End = inst_end(F); i != End;
+       ++i) {
+    const Instruction *I = &*i;
+    assert(I->getOpcode() < 256 && "Opcode does not fit in a byte");
+    Opcodes.push_back(I->getOpcode());
+    ValueInfoMap::iterator j = ValueInfos.find(I);
+    if (j == ValueInfos.end()) {
+      // Unreachable.
+      Body.push_back(0);
+      continue;
+    }
+    ValueInfo *VI = j->second.getPtr();
+    if (VI && VI->getValue() == I) {
+      VI->V = 0;
+      AnonymousValueInfos.push_back(VI);
+    }
+    Body.push_back(VI);
+    ValueInfos.erase(j);
+  }
+  while (!Body.empty() && !Body.back()) {
+    Body.pop_back();
+  }
+  ValueInfoVector(Body).swap(Body);
+  std::vector<uint8_t>(Opcodes).swap(Opcodes);
+}
+
 void Data::visitValueInfos(ValueInfoVisitorFn visitor, void *Arg) const {
   for (ValueInfoMap::const_iterator i = ValueInfos.begin(),
                                     End = ValueInfos.end();
@@ -102,6 +642,12 @@ void Data::visitValueInfos(ValueInfoVisitorFn visitor, void *Arg) const {
     if (!i->second.getPtr() || i->first != i->second->getValue()) continue;
     (*visitor)(Arg, i->second.getPtr());
   }
+  for (ValueInfoMap::const_iterator i = InitializerValueInfos.begin(),
+                                    End = InitializerValueInfos.end();
+       i != End; ++i) {
+    if (!i->second.getPtr() || i->first != i->second->getValue()) continue;
+    (*visitor)(Arg, i->second.getPtr());
+  }
   for (ValueInfoMap::const_iterator i = GlobalRegionInfos.begin(),
                                     End = GlobalRegionInfos.end();
        i != End; ++i) {
@@ -17,12 +17,19 @@
 #include "AnalysisResult.h"
 #include "GraphNode.h"
 #include "ValueInfo.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringRef.h"
 
+#include <cassert>
 #include <vector>
 
 namespace llvm {
 
 class Function;
+class Instruction;
+class Module;
 class raw_ostream;
 class Value;
 
@@ -31,19 +38,77 @@ class Value;
 namespace llvm {
 namespace andersen_internal {
 
+class AlgorithmId;
+class AliasClasses;
+class BackgroundSolver;
+class Components;
 class DebugInfo;
 class DebugInfoFiller;
+class Derivations;
+class EnumerationSession;
+class FinishedSet;
+class RelationStore;
 
 // TODO: Should this be a ValueMap?
 typedef DenseMap<const Value *, ValueInfo::Ref> ValueInfoMap;
 typedef std::vector<ValueInfo::Ref> ValueInfoVector;
+typedef SetVector<ValueInfo *> ValueInfoSetVector;
+typedef DenseMap<const Function *, ValueInfoVector> FunctionBodyMap;
+typedef DenseMap<const Function *, std::vector<uint8_t> > FunctionOpcodeMap;
 
 class Data : public GraphNode {
+  friend class AnalysisResult;
+  friend class ConstraintFile;
   friend class InstructionAnalyzer;
 
+  // All ValueInfos by id. Sets refer to their elements by id, so this keeps
+  // every ValueInfo alive as long as the Data.
+  std::vector<ValueInfo::Ref> ValueInfosById;
+  // Number of AnalysisResults given an id so far, which is also the next free
+  // id.
+  uint32_t NumAnalysisResults;
+  // Total size of the sets of all ARs, as an estimate of their memory. ARs
+  // that have elements are only deleted along with the Data.
+  size_t NumSetElements;
+  // The transforms that work refers to by index, and the index of each. There
+  // is one per transforming algorithm, so this stays tiny, but it grows
+  // whenever enumeration first applies another one.
+  std::vector<const TransformAlgorithm *> Transforms;
+  DenseMap<const TransformAlgorithm *, uint32_t> TransformIndices;
+  // The points-to set of ExternallyAccessibleRegions, or null if not created
+  // yet. Sets hold it by a flag rather than by copying its elements.
+  AnalysisResult *Universe;
+  // For each transform, the AR of its results over the elements of Universe,
+  // which every transform of a set that holds Universe reads as a subset.
+  // Created during enumeration and owned here.
+  DenseMap<const TransformAlgorithm *, AnalysisResult *> UniverseTransforms;
+  // Number of ARs that have come to hold Universe. A set that is done with a
+  // cycle compares it to tell whether its last round added anything.
+  uint32_t NumUniverseHolders;
+  // Estimated memory use below which relieveMemoryPressure does nothing even
+  // if over its limit, to avoid sweeping again when little can be released.
+  size_t NextSweepBytes;
+  // The first AR that shareTransformResult saw for each transform and
+  // canonical input.
+  typedef std::pair<const TransformAlgorithm *, AnalysisResult *> TransformKey;
+  DenseMap<TransformKey, AnalysisResult *> SharedTransforms;
+  // A copy of the elements of a set for the queries that return one, and
+  // whether it is final because the set was done when it was last updated.
+  struct SetCopy {
+    ValueInfoSetVector Set;
+    bool Final;
+
+    SetCopy() : Final(false) {}
+  };
+  DenseMap<const AnalysisResult *, SetCopy *> SetCopies;
+
 public:
   // ValueInfo for all Values used in the Module.
   ValueInfoMap ValueInfos;
+  // ValueInfo for constants first analyzed as part of a deferred global
+  // initializer. Kept apart from ValueInfos, which may be iterated over while
+  // these are added.
+  ValueInfoMap InitializerValueInfos;
   // ValueInfo for all global regions (GlobalVariable or Function) defined in
   // the Module. These only differ from the ValueInfos entry if the symbol is
   // overridable.
@@ -55,21 +120,155 @@ public:
   const ValueInfo::Ref ExternallyAccessibleRegions;
   // VIs not associated with any Value (e.g., generated for intrinsics).
   ValueInfoVector AnonymousValueInfos;
+  // ValueInfo for the instructions of functions whose bodies were discarded
+  // after analysis, by the position of the instruction in its function, which
+  // stays the same when the body is read in again. Null entries are for
+  // instructions that point to nothing or were unreachable.
+  FunctionBodyMap DematerializedValueInfos;
+  // The opcodes of all of the instructions of those functions when they were
+  // discarded, so that a body changed after it was read in again is noticed.
+  FunctionOpcodeMap DematerializedOpcodes;
   // A special always-empty AR for use with getPointsToSet.
   AnalysisResult EmptyAnalysisResult;
+  // Classes of small finished points-to sets, or null if not computed.
+  AliasClasses *Classes;
+  // Connected components of the relations, or null if not computed.
+  Components *Comps;
+  // The relations from which ARs are built when first needed, or null if
+  // instruction analysis built all of them.
+  RelationStore *Relations;
+  // Where enumeration found the elements of each AR, or null if not
+  // recorded.
+  Derivations *Derivs;
+  // The thread solving sets of this data ahead of queries, or null if none is
+  // running.
+  BackgroundSolver *Solver;
 
   virtual ~Data();
 
-  virtual GraphEdgeDeque getOutgoingEdges() const;
+  virtual void getOutgoingEdges(const Data &D, GraphEdgeVector &Edges) const;
   virtual void printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const;
   virtual bool isNodeHidden() const;
 
   void fillDebugInfo(DebugInfoFiller *DIF) const;
   void writeEquations(const DebugInfo &DI, raw_ostream &OS) const;
 
+  uint32_t getNumValueInfos() const { return ValueInfosById.size(); }
+
+  size_t getNumSetElements() const { return NumSetElements; }
+
+  ValueInfo *getValueInfo(uint32_t Id) const {
+    assert(Id < ValueInfosById.size());
+    return ValueInfosById[Id].getPtr();
+  }
+
+  // Give a newly created AR its id.
+  void addAnalysisResult(AnalysisResult *AR) {
+    AR->Id = NumAnalysisResults++;
+    AR->Owner = this;
+  }
+
+  // Give AR, newly created as the result of Algorithm for VI, its id.
+  void addAnalysisResult(const ValueInfo *VI, const AlgorithmId *Algorithm,
+                         AnalysisResult *AR);
+
+  AnalysisResult *getUniverse() const { return Universe; }
+
+  // The AR of the results of Transform over the elements of the universe,
+  // which must exist.
+  AnalysisResult *getUniverseTransform(const TransformAlgorithm *Transform);
+
+  // The relations if results are built from them, which they are once
+  // instruction analysis has finished recording them. Null otherwise.
+  RelationStore *getFinishedRelations() const;
+
+  // The index of Transform in the table of the transforms in use, which is
+  // added if not there yet.
+  uint32_t getTransformIndex(const TransformAlgorithm *Transform);
+
+  const TransformAlgorithm *getTransform(uint32_t Index) const {
+    assert(Index < Transforms.size());
+    return Transforms[Index];
+  }
+
+  // Find the VI of V, which is null if V points to nothing. Returns false if V
+  // was not analyzed, including when V is in a body read in again that no
+  // longer has the instructions that were analyzed.
+  bool lookupValueInfo(const Value *V, ValueInfo *&VI) const;
+
+  // Whether V is an instruction of a body read in again after analysis that
+  // passes have changed since, so that V may never have been analyzed.
+  bool isInChangedBody(const Value *V) const;
+
+  // Find the VI of the value of M with the given name, written as in
+  // constraint files (@g, @g.region, @f:%x or @f:#N). Returns null if there is
+  // none or it points to nothing.
+  ValueInfo *findValueInfo(const Module &M, StringRef Name) const;
+
+  // Move the VIs of the instructions of F to DematerializedValueInfos, so that
+  // F's body can be discarded. VIs of instructions become anonymous.
+  void forgetFunctionBody(const Function &F);
+
+  // Get the compact form of a done AR. Sets that contain everything that
+  // ExternallyAccessibleRegions points to represent that part implicitly.
+  // Returns null if Session runs out of budget while solving that set, the
+  // universe.
+  const FinishedSet *getFinishedSet(AnalysisResult *AR,
+                                    EnumerationSession *Session = 0);
+
+  // Get a copy of the elements of AR computed so far, in the order of a
+  // PointsToSetView of AR. The copy lives as long as the Data, and each call
+  // for the same AR updates it with the elements found since.
+  const ValueInfoSetVector &getSetCopy(const AnalysisResult *AR);
+
+  // Append the unfinished ARs that Roots read, directly or through the inputs
+  // of pending work, to Order in post-order, so that solving them in that
+  // order finishes each input before the sets that read it. Null and done
+  // roots are skipped, and each AR appears once.
+  void getSolveOrder(ArrayRef<AnalysisResult *> Roots,
+                     std::vector<AnalysisResult *> &Order) const;
+
+  // If the estimated memory use of all sets exceeds MaxBytes, discard the
+  // contents of done intermediate results that can be computed again. Must not
+  // be called during an enumeration.
+  void relieveMemoryPressure(size_t MaxBytes);
+
+  // Discard the contents of the done intermediate results of VIs, like
+  // relieveMemoryPressure, but regardless of memory use. No set outside VIs
+  // may read the results of VIs, as for a component that is not external.
+  // Must not be called during an enumeration.
+  void releaseIntermediateResults(ArrayRef<ValueInfo *> VIs);
+
+  // Renumber the ValueInfos in a reverse post-order of the subset and
+  // transform graph from the points-to sets of the ValueInfos, so that the ids
+  // of the elements of a set tend to be close together. Only valid before
+  // enumeration starts, and not with Relations.
+  void renumber();
+
+  // Make each AR that is only a transform of an input equal to that of an
+  // earlier AR reuse the earlier AR's result as a subset, so that the union is
+  // computed once. Inputs are compared after looking through ARs that are only
+  // a whole other AR. Only valid before enumeration starts, and not with
+  // Relations.
+  void shareTransformResults();
+
+  // Like shareTransformResults, for the single newly built AR, which is
+  // compared with those seen so far. The input of its transform, and the ARs
+  // that input holds whole, must have all their work.
+  void shareTransformResult(AnalysisResult *AR);
+
 private:
-  Data(ValueInfo *ExternallyLinkableRegions,
-       ValueInfo *ExternallyAccessibleRegions);
+  Data();
+
+  ValueInfo *createValueInfo(const Value *V);
+
+  // Index the relations recorded by instruction analysis, from which the ARs
+  // are then built when first needed.
+  void finishRelations();
+
+  // Find the position of I in its function, whose body was discarded after
+  // analysis. Returns false if the body no longer has the opcodes it had then.
+  bool getDematerializedPosition(const Instruction *I, size_t &Position) const;
 
   typedef void (*ValueInfoVisitorFn)(void *, ValueInfo *);
 
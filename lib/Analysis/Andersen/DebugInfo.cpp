@@ -118,7 +118,11 @@ void DebugInfo::printValueInfoName(const ValueInfo *VI, raw_ostream &OS) const {
 void DebugInfo::printAnalysisResultName(const AnalysisResult *AR,
                                         raw_ostream &OS) const {
   AnalysisResultInfoMap::const_iterator i = ARIM.find(AR);
-  assert(i != ARIM.end());
+  if (i == ARIM.end()) {
+    // Not the result of any VI, like Data::EmptyAnalysisResult.
+    OS << "Anonymous" << AR;
+    return;
+  }
   i->second.second->printAlgorithmName(OS);
   OS << '(';
   printValueInfoName(i->second.first, OS);
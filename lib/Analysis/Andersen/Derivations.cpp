@@ -0,0 +1,190 @@
+//===- Derivations.cpp - why sets contain their elements ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type that records where enumeration found each element
+// of each analysis result, so that the membership of an element can be traced
+// back to the result that first held it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Derivations.h"
+
+#include "AlgorithmId.h"
+#include "AnalysisResult.h"
+#include "DebugInfo.h"
+#include "ValueInfo.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cassert>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+const char *getRelationTypeName(RelationType RT) {
+  switch (RT) {
+  case ARGUMENT_FROM_CALLER:
+    return "argument-from-caller";
+  case ARGUMENT_TO_CALLEE:
+    return "argument-to-callee";
+  case DEPENDS_ON:
+    return "depends-on";
+  case LOADED_FROM:
+    return "loaded-from";
+  case RETURNED_FROM_CALLEE:
+    return "returned-from-callee";
+  case RETURNED_TO_CALLER:
+    return "returned-to-caller";
+  case STORED_TO:
+    return "stored-to";
+  }
+  llvm_unreachable("Not a recognized RelationType");
+}
+
+}
+
+Derivations *Derivations::Active = 0;
+
+Derivations::Derivations() {
+  assert(!Active);
+  Active = this;
+  Relation None = { DEPENDS_ON, 0, 0 };
+  Current = None;
+}
+
+Derivations::~Derivations() {
+  assert(Active == this);
+  Active = 0;
+}
+
+void Derivations::setCurrentRelation(RelationType RT, const ValueInfo *Src,
+                                     const ValueInfo *Dst) {
+  Relation Rel = { RT, Src, Dst };
+  Current = Rel;
+}
+
+void Derivations::addRelation(const AnalysisResult *AR,
+                              const AnalysisResult *Subset,
+                              const Relation &Rel) {
+  if (!Rel.Src) {
+    return;
+  }
+  // Keep the first relation. Later ones only add the same subset again.
+  Relations.insert(std::make_pair(SubsetKey(AR, Subset), Rel));
+}
+
+void Derivations::addSource(const AnalysisResult *AR, const ValueInfo *VI,
+                            const AnalysisResult *Source) {
+  // Keep the first source. Later ones come from recomputation after eviction.
+  Sources.insert(std::make_pair(MemberKey(AR, VI), Source));
+}
+
+void Derivations::addUniverse(const AnalysisResult *AR,
+                              const AnalysisResult *Source) {
+  UniverseSources.insert(std::make_pair(AR, Source));
+}
+
+void Derivations::addTransform(const AnalysisResult *AR,
+                               const AnalysisResult *Subset,
+                               const AlgorithmId *Id,
+                               const AnalysisResult *Input,
+                               const ValueInfo *Element) {
+  TransformStep Step = { Id, Input, Element };
+  Transforms.insert(std::make_pair(SubsetKey(AR, Subset), Step));
+}
+
+void Derivations::moveSubset(const AnalysisResult *AR,
+                             const AnalysisResult *From,
+                             const AnalysisResult *NewAR,
+                             const AnalysisResult *To) {
+  DenseMap<SubsetKey, TransformStep>::const_iterator i =
+      Transforms.find(SubsetKey(AR, From));
+  if (i != Transforms.end()) {
+    TransformStep Step = i->second;
+    Transforms.insert(std::make_pair(SubsetKey(NewAR, To), Step));
+  }
+  DenseMap<SubsetKey, Relation>::const_iterator j =
+      Relations.find(SubsetKey(AR, From));
+  if (j != Relations.end()) {
+    Relation Rel = j->second;
+    Relations.insert(std::make_pair(SubsetKey(NewAR, To), Rel));
+  }
+}
+
+void Derivations::explain(const DebugInfo &DI, const AnalysisResult *AR,
+                          const ValueInfo *VI, raw_ostream &OS) const {
+  OS << "Element ";
+  DI.printValueInfoName(VI, OS);
+  OS << '\n';
+  SmallPtrSet<const AnalysisResult *, 16> Visited;
+  for (;;) {
+    OS << "  is in ";
+    DI.printAnalysisResultName(AR, OS);
+    OS << '\n';
+    DenseMap<MemberKey, const AnalysisResult *>::const_iterator i =
+        Sources.find(MemberKey(AR, VI));
+    if (i == Sources.end()) {
+      // Elements only held through the universe have no source of their own.
+      DenseMap<const AnalysisResult *, const AnalysisResult *>::const_iterator
+          k = UniverseSources.find(AR);
+      if (k == UniverseSources.end() ||
+          AR->getSetContentsSoFar().count(VI->getId())) {
+        OS << "  which held it when it was built from the relations\n";
+        return;
+      }
+      if (!Visited.insert(AR)) {
+        OS << "  which is where this path started over\n";
+        return;
+      }
+      OS << "  because it holds the escaped universe, as does\n";
+      AR = k->second;
+      continue;
+    }
+    if (!Visited.insert(AR)) {
+      OS << "  which is where this path started over\n";
+      return;
+    }
+    const AnalysisResult *Source = i->second;
+    DenseMap<SubsetKey, TransformStep>::const_iterator j =
+        Transforms.find(SubsetKey(AR, Source));
+    if (j != Transforms.end()) {
+      OS << "  because it includes ";
+      j->second.Id->printAlgorithmName(OS);
+      if (j->second.Element) {
+        OS << " of element ";
+        DI.printValueInfoName(j->second.Element, OS);
+        OS << " of ";
+      } else {
+        OS << " of the escaped universe held by ";
+      }
+      DI.printAnalysisResultName(j->second.Input, OS);
+      OS << ",\n";
+    } else {
+      DenseMap<SubsetKey, Relation>::const_iterator k =
+          Relations.find(SubsetKey(AR, Source));
+      if (k != Relations.end()) {
+        OS << "  because the " << getRelationTypeName(k->second.RT)
+           << " relation from ";
+        DI.printValueInfoName(k->second.Src, OS);
+        OS << " to ";
+        DI.printValueInfoName(k->second.Dst, OS);
+        OS << " makes it include\n";
+      } else {
+        OS << "  because it includes\n";
+      }
+    }
+    AR = Source;
+  }
+}
+
+}
+}
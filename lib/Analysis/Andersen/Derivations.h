@@ -0,0 +1,124 @@
+//===- Derivations.h - why sets contain their elements --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type that records where enumeration found each element
+// of each analysis result, so that the membership of an element can be traced
+// back to the result that first held it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DERIVATIONS_H
+#define DERIVATIONS_H
+
+#include "RelationType.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <utility>
+
+namespace llvm {
+
+class raw_ostream;
+
+}
+
+namespace llvm {
+namespace andersen_internal {
+
+class AlgorithmId;
+class AnalysisResult;
+class DebugInfo;
+class ValueInfo;
+
+// Only one can be recording at a time. While none is, the hooks in instruction
+// analysis and enumeration cost a single test.
+class Derivations {
+public:
+  // A relation turned into work, or none if Src is null.
+  struct Relation {
+    RelationType RT;
+    const ValueInfo *Src;
+    const ValueInfo *Dst;
+  };
+
+private:
+  // A subset added by a transform: the result of algorithm Id for Element,
+  // which was read from Input, or for all of the universe that Input holds if
+  // Element is null.
+  struct TransformStep {
+    const AlgorithmId *Id;
+    const AnalysisResult *Input;
+    const ValueInfo *Element;
+  };
+
+  typedef std::pair<const AnalysisResult *, const ValueInfo *> MemberKey;
+  typedef std::pair<const AnalysisResult *, const AnalysisResult *> SubsetKey;
+
+  // The set each element of each AR was first read from. Elements with no
+  // entry were put in the AR when it was built.
+  DenseMap<MemberKey, const AnalysisResult *> Sources;
+  // Why an AR has a subset, for the subsets added by transforms.
+  DenseMap<SubsetKey, TransformStep> Transforms;
+  // Why an AR has a subset, for the subsets added by relations.
+  DenseMap<SubsetKey, Relation> Relations;
+  // The relation being turned into work.
+  Relation Current;
+  // The set each AR that holds the universe first got it from.
+  DenseMap<const AnalysisResult *, const AnalysisResult *> UniverseSources;
+
+  static Derivations *Active;
+
+public:
+  // Starts recording.
+  Derivations();
+  // Stops recording.
+  ~Derivations();
+
+  static Derivations *getActive() { return Active; }
+
+  // The work added next comes from the relation.
+  void setCurrentRelation(RelationType RT, const ValueInfo *Src,
+                          const ValueInfo *Dst);
+
+  // The relation being turned into work. Creating the ARs for it can turn
+  // other relations into work first, so read it before that.
+  const Relation &getCurrentRelation() const { return Current; }
+
+  // The relation Rel made Subset a subset of AR.
+  void addRelation(const AnalysisResult *AR, const AnalysisResult *Subset,
+                   const Relation &Rel);
+
+  // VI was added to AR after being read from Source.
+  void addSource(const AnalysisResult *AR, const ValueInfo *VI,
+                 const AnalysisResult *Source);
+
+  // AR came to hold the universe by reading Source, the universe or a set that
+  // holds it.
+  void addUniverse(const AnalysisResult *AR, const AnalysisResult *Source);
+
+  // AR got the subset Subset, the result of algorithm Id for Element of Input,
+  // or for the universe held by Input if Element is null.
+  void addTransform(const AnalysisResult *AR, const AnalysisResult *Subset,
+                    const AlgorithmId *Id, const AnalysisResult *Input,
+                    const ValueInfo *Element);
+
+  // The subset From of AR is now read as the subset To of NewAR, which holds a
+  // subset of From, so it inherits any reason recorded for From.
+  void moveSubset(const AnalysisResult *AR, const AnalysisResult *From,
+                  const AnalysisResult *NewAR, const AnalysisResult *To);
+
+  // Print the chain of sets through which VI reached AR, which must contain
+  // it, ending at the set that held it from the start.
+  void explain(const DebugInfo &DI, const AnalysisResult *AR,
+               const ValueInfo *VI, raw_ostream &OS) const;
+};
+
+}
+}
+
+#endif
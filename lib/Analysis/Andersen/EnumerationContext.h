@@ -16,11 +16,15 @@
 
 #include "AnalysisResult.h"
 #include "AnalysisResultWork.h"
-#include "SubsetWork.h"
+
+#include "llvm/Support/DataTypes.h"
 
 namespace llvm {
 namespace andersen_internal {
 
+class Data;
+class EnumerationSession;
+
 class ScopedSetEnumerating {
   friend class EnumerationContext;
 
@@ -41,17 +45,28 @@ class ScopedSetEnumerating {
 class EnumerationContext : private ScopedSetEnumerating {
   friend class AnalysisResult;
 
+  Data &D;
   const int Depth;
   const int LastTransformDepth;
-  AnalysisResultWorkList::iterator Pos;
-
-  EnumerationContext(AnalysisResult *AR, int Depth, int LastTransformDepth)
+  EnumerationSession *const Session;
+  // Index of the current work. Nested enumeration only ever appends to this
+  // AR's work list, so this stays valid across it, but references into the
+  // list do not.
+  uint32_t Pos;
+
+  EnumerationContext(Data &D, AnalysisResult *AR, int Depth,
+                     int LastTransformDepth, EnumerationSession *Session)
     : ScopedSetEnumerating(AR, Depth),
+      D(D),
       Depth(Depth),
       LastTransformDepth(LastTransformDepth),
-      Pos(AR->Work.begin()) {}
+      Session(Session),
+      Pos(0) {}
 
 public:
+  // The analysis data the enumerated sets belong to.
+  Data &getData() const { return D; }
+
   int getDepth() const { return Depth; }
 
   int getLastTransformDepth() const { return LastTransformDepth; }
@@ -60,24 +75,33 @@ public:
 
   AnalysisResult *getAnalysisResult() const { return AR; }
 
+  // Null if the enumeration is unbounded.
+  EnumerationSession *getSession() const { return Session; }
+
+  AnalysisResultWork &getCurrentWork() const {
+    assert(Pos < AR->Work.size());
+    return AR->Work[Pos];
+  }
+
   bool canInline() const {
     assert(!AR->isDone());
-    // If this AR has a work list containing a sole SubsetWork and the level
-    // above is also a SubsetWork, then the inner one can be inlined into the
+    // If this AR has a work list containing a sole subset and the level
+    // above is also a subset, then the inner one can be inlined into the
     // upper one. Doing so gives up the chance to share the work done to filter
     // out repeated VIs, but it has the advantage that redundant ARs can be
     // erased, which is necessary when retries are involved.
-    return getDepth() > getLastTransformDepth() + 1 &&
-           ++AR->Work.begin() == AR->Work.end();
+    return getDepth() > getLastTransformDepth() + 1 && AR->Work.size() == 1;
   }
 
-  SubsetWork *pushSubset(AnalysisResult *Subset) {
+  // Insert a subset before the current work and make it the current work.
+  // Returns false if it was not inserted.
+  bool pushSubset(AnalysisResult *Subset) {
     if (AR->prepareForSubset(Subset)) {
-      SubsetWork *SW = new SubsetWork(Subset);
-      Pos = AR->Work.insert(Pos, SW);
-      return SW;
+      AR->Work.insert(AR->Work.begin() + Pos,
+                      AnalysisResultWork::makeSubset(Subset));
+      return true;
     } else {
-      return 0;
+      return false;
     }
   }
 };
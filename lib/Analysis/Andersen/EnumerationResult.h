@@ -14,14 +14,15 @@
 #ifndef ENUMERATIONRESULT_H
 #define ENUMERATIONRESULT_H
 
+#include "Enumerator.h"
+#include "llvm/Support/DataTypes.h"
+
 #include <cassert>
 
 namespace llvm {
 namespace andersen_internal {
 
 class AnalysisResult;
-class Enumerator;
-class ValueInfo;
 
 class EnumerationResult {
 public:
@@ -30,38 +31,48 @@ public:
     INLINE,
     RETRY,
     REWRITE,
-    COMPLETE
+    COMPLETE,
+    SUSPEND
   };
 
 private:
   Type type;
+  // Position of the inline enumerator. It fits in the padding after type, so
+  // the result stays two words.
+  uint32_t InlinePosition;
   union {
-    ValueInfo *NextValue;
-    Enumerator *InlineEnumerator;
+    // The id of the ValueInfo for NEXT_VALUE.
+    uint32_t NextValue;
+    // The AR of the inline enumerator for INLINE.
     AnalysisResult *AR;
     void *Unused;
   };
 
-  explicit EnumerationResult(ValueInfo *NextValue)
-    : type(NEXT_VALUE), NextValue(NextValue) {}
+  explicit EnumerationResult(uint32_t NextValue)
+    : type(NEXT_VALUE), InlinePosition(0), NextValue(NextValue) {}
 
-  explicit EnumerationResult(Enumerator *InlineEnumerator)
-    : type(INLINE), InlineEnumerator(InlineEnumerator) {}
+  explicit EnumerationResult(const Enumerator &InlineEnumerator)
+    : type(INLINE),
+      InlinePosition(InlineEnumerator.getPosition()),
+      AR(InlineEnumerator.getAnalysisResult()) {}
 
   EnumerationResult(Type type, AnalysisResult *AR)
-    : type(type), AR(AR) {
+    : type(type), InlinePosition(0), AR(AR) {
     assert(type == RETRY || type == REWRITE);
   }
 
-  EnumerationResult()
-    : type(COMPLETE), Unused(0) {}
+  explicit EnumerationResult(Type type)
+    : type(type), InlinePosition(0), Unused(0) {
+    assert(type == COMPLETE || type == SUSPEND);
+  }
 
 public:
-  static EnumerationResult makeNextValueResult(ValueInfo *NextValue) {
+  static EnumerationResult makeNextValueResult(uint32_t NextValue) {
     return EnumerationResult(NextValue);
   }
 
-  static EnumerationResult makeInlineResult(Enumerator *InlineEnumerator) {
+  static EnumerationResult makeInlineResult(
+      const Enumerator &InlineEnumerator) {
     return EnumerationResult(InlineEnumerator);
   }
 
@@ -76,21 +87,25 @@ public:
   }
 
   static EnumerationResult makeCompleteResult() {
-    return EnumerationResult();
+    return EnumerationResult(COMPLETE);
+  }
+
+  static EnumerationResult makeSuspendResult() {
+    return EnumerationResult(SUSPEND);
   }
 
   Type getResultType() const {
     return type;
   }
 
-  ValueInfo *getNextValue() const {
+  uint32_t getNextValue() const {
     assert(type == NEXT_VALUE);
     return NextValue;
   }
 
-  Enumerator *getInlineEnumerator() const {
+  Enumerator getInlineEnumerator() const {
     assert(type == INLINE);
-    return InlineEnumerator;
+    return Enumerator(AR, InlinePosition);
   }
 
   AnalysisResult *getRetryCancellationPoint() const {
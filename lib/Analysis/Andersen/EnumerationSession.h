@@ -0,0 +1,55 @@
+//===- EnumerationSession.h - enumeration work budget ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the session of one top-level enumeration request: the
+// state shared by all levels of the request, which is the budget of work it
+// may do before it suspends.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ENUMERATIONSESSION_H
+#define ENUMERATIONSESSION_H
+
+namespace llvm {
+namespace andersen_internal {
+
+class EnumerationSession {
+  unsigned StepsLeft;
+  bool Limited;
+  bool Suspended;
+
+public:
+  // A session with no limit on the work done.
+  EnumerationSession() : StepsLeft(0), Limited(false), Suspended(false) {}
+
+  // A session that suspends after Budget units of work.
+  explicit EnumerationSession(unsigned Budget)
+    : StepsLeft(Budget), Limited(true), Suspended(false) {}
+
+  // Account for one unit of work. Returns false if the budget is exhausted, in
+  // which case the enumeration must unwind with a suspend-result.
+  bool step() {
+    if (!Limited) {
+      return true;
+    }
+    if (!StepsLeft) {
+      Suspended = true;
+      return false;
+    }
+    --StepsLeft;
+    return true;
+  }
+
+  bool isSuspended() const { return Suspended; }
+};
+
+}
+}
+
+#endif
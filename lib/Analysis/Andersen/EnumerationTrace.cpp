@@ -0,0 +1,157 @@
+//===- EnumerationTrace.cpp - trace of enumeration activity ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type that records how long queries and the enumeration
+// of each analysis result take, for output in the Chrome trace event format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "EnumerationTrace.h"
+
+#include "DebugInfo.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cassert>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+// Write Str as a JSON string.
+void writeString(StringRef Str, raw_ostream &OS) {
+  OS << '"';
+  for (StringRef::iterator i = Str.begin(), End = Str.end(); i != End; ++i) {
+    unsigned char C = *i;
+    if (C == '"' || C == '\\') {
+      OS << '\\' << C;
+    } else if (C < 0x20) {
+      OS << "\\u" << format("%04x", C);
+    } else {
+      OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void writeSetName(const DebugInfo &DI, const AnalysisResult *AR,
+                  raw_ostream &OS) {
+  SmallString<128> Name;
+  {
+    raw_svector_ostream NameOS(Name);
+    DI.printAnalysisResultName(AR, NameOS);
+  }
+  writeString(Name, OS);
+}
+
+}
+
+EnumerationTrace *EnumerationTrace::Active = 0;
+unsigned EnumerationTrace::CurrentThread = 0;
+
+uint64_t EnumerationTrace::now() {
+  return sys::TimeValue::now().usec();
+}
+
+EnumerationTrace::EnumerationTrace(const Data *D, raw_ostream *OS,
+                                   size_t MaxEnumerations, int MaxDepth,
+                                   uint64_t MinDuration)
+  : D(D), OS(OS), MaxEnumerations(MaxEnumerations), MaxDepth(MaxDepth),
+    MinDuration(MinDuration), NumEnumerations(0), NumWritten(0),
+    NumDropped(0), NumOpen(0), StartTime(now()) {
+  assert(!Active);
+  Active = this;
+  CurrentThread = 0;
+  *OS << "{\"traceEvents\":[";
+}
+
+EnumerationTrace::~EnumerationTrace() {
+  assert(Active == this);
+  Active = 0;
+  flush();
+  *OS << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":"
+      << NumDropped << "}}\n";
+}
+
+void EnumerationTrace::record(const char *Query, const AnalysisResult *AR,
+                              const AnalysisResult *Other, int Depth,
+                              uint64_t Begin) {
+  uint64_t Duration = now() - Begin;
+  assert(NumOpen);
+  --NumOpen;
+  // Query spans are always kept.
+  if (!Query) {
+    if (Duration < MinDuration || NumEnumerations == MaxEnumerations) {
+      ++NumDropped;
+      return;
+    }
+    ++NumEnumerations;
+  }
+  Event E;
+  E.Query = Query;
+  E.AR = AR;
+  E.Other = Other;
+  E.Begin = Begin;
+  E.Duration = Duration;
+  E.Depth = Depth;
+  E.Thread = CurrentThread;
+  Events.push_back(E);
+  // Writing inside a span would count toward it.
+  if (!NumOpen && Events.size() >= 4096) {
+    flush();
+  }
+}
+
+void EnumerationTrace::flush() {
+  if (Events.empty()) {
+    return;
+  }
+  // Sets can be built while solving, so name them with the data as it is now.
+  DebugInfo DI(D);
+  for (std::vector<Event>::const_iterator i = Events.begin(),
+                                          End = Events.end();
+       i != End; ++i) {
+    if (NumWritten++) {
+      *OS << ',';
+    }
+    *OS << "\n{\"name\":";
+    if (i->Query) {
+      writeString(i->Query, *OS);
+      *OS << ",\"cat\":\"query\"";
+    } else {
+      writeSetName(DI, i->AR, *OS);
+      *OS << ",\"cat\":\"enumerate\"";
+    }
+    *OS << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << i->Thread
+        << ",\"ts\":" << (i->Begin - StartTime)
+        << ",\"dur\":" << i->Duration << ",\"args\":{";
+    if (i->Query) {
+      *OS << "\"set\":";
+      if (i->AR) {
+        writeSetName(DI, i->AR, *OS);
+      } else {
+        *OS << "null";
+      }
+      if (i->Other) {
+        *OS << ",\"other\":";
+        writeSetName(DI, i->Other, *OS);
+      }
+    } else {
+      *OS << "\"depth\":" << i->Depth;
+    }
+    *OS << "}}";
+  }
+  Events.clear();
+}
+
+}
+}
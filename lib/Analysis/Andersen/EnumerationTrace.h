@@ -0,0 +1,143 @@
+//===- EnumerationTrace.h - trace of enumeration activity -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type that records how long queries and the enumeration
+// of each analysis result take, for output in the Chrome trace event format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ENUMERATIONTRACE_H
+#define ENUMERATIONTRACE_H
+
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace llvm {
+
+class raw_ostream;
+
+}
+
+namespace llvm {
+namespace andersen_internal {
+
+class AnalysisResult;
+class Data;
+
+// Spans are kept as pointers and times only, and are named when they are
+// written, so that tracing costs two clock reads per span. Every query span is
+// kept. Enumeration spans nested deeper than a given depth are not timed at
+// all, and those shorter than a given duration or beyond a given number are
+// dropped, since a query can run millions of them. Finished spans are written
+// out whenever no span is open and enough have gathered, so memory stays
+// bounded. Only one trace can be active at a time. While none is, a Span costs
+// a single test.
+class EnumerationTrace {
+  struct Event {
+    // The name of the query, or null for the enumeration of AR.
+    const char *Query;
+    const AnalysisResult *AR;
+    // The second set of a query on two sets.
+    const AnalysisResult *Other;
+    uint64_t Begin;
+    uint64_t Duration;
+    int Depth;
+    unsigned Thread;
+  };
+
+  // The data the sets belong to, to name them.
+  const Data *const D;
+  OwningPtr<raw_ostream> OS;
+  // Finished spans not yet written.
+  std::vector<Event> Events;
+  const size_t MaxEnumerations;
+  const int MaxDepth;
+  const uint64_t MinDuration;
+  size_t NumEnumerations;
+  size_t NumWritten;
+  size_t NumDropped;
+  // Number of spans begun and not yet finished.
+  unsigned NumOpen;
+  const uint64_t StartTime;
+
+  static EnumerationTrace *Active;
+  static unsigned CurrentThread;
+
+  static uint64_t now();
+
+  // Returns the active trace if it times enumerations at Depth.
+  static EnumerationTrace *getTraceForDepth(int Depth) {
+    return Active && Depth <= Active->MaxDepth ? Active : 0;
+  }
+
+  void record(const char *Query, const AnalysisResult *AR,
+              const AnalysisResult *Other, int Depth, uint64_t Begin);
+
+  // Write the finished spans out.
+  void flush();
+
+public:
+  // Records the time from its construction to its destruction if a trace is
+  // active.
+  class Span {
+    EnumerationTrace *const Trace;
+    const char *const Query;
+    const AnalysisResult *const AR;
+    const AnalysisResult *const Other;
+    const int Depth;
+    uint64_t Begin;
+
+  public:
+    // A query on the sets AR and Other, either of which may be null.
+    Span(const char *Query, const AnalysisResult *AR,
+         const AnalysisResult *Other = 0)
+      : Trace(Active), Query(Query), AR(AR), Other(Other), Depth(0) {
+      if (Trace) {
+        ++Trace->NumOpen;
+        Begin = now();
+      }
+    }
+
+    // The enumeration of AR at the given nesting depth.
+    Span(const AnalysisResult *AR, int Depth)
+      : Trace(getTraceForDepth(Depth)), Query(0), AR(AR), Other(0),
+        Depth(Depth) {
+      if (Trace) {
+        ++Trace->NumOpen;
+        Begin = now();
+      }
+    }
+
+    ~Span() {
+      if (Trace) {
+        Trace->record(Query, AR, Other, Depth, Begin);
+      }
+    }
+  };
+
+  // Starts tracing the queries on D to OS, which it takes ownership of. Keeps
+  // the first MaxEnumerations enumeration spans no deeper than MaxDepth that
+  // take at least MinDuration microseconds.
+  EnumerationTrace(const Data *D, raw_ostream *OS, size_t MaxEnumerations,
+                   int MaxDepth, uint64_t MinDuration);
+  // Stops tracing, and finishes the output.
+  ~EnumerationTrace();
+
+  // Set the thread that spans are attributed to from now on. 0 is the thread
+  // running the passes.
+  static void setThread(unsigned Thread) { CurrentThread = Thread; }
+};
+
+}
+}
+
+#endif
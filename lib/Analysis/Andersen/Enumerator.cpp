@@ -19,19 +19,16 @@
 #include "GraphNode.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include <sstream>
-
 namespace llvm {
 namespace andersen_internal {
 
-EnumerationResult Enumerator::enumerate(int Depth, int LastTransformDepth) {
-  return AR->enumerate(Depth, LastTransformDepth, i);
+EnumerationResult Enumerator::enumerate(Data &D, int Depth,
+    int LastTransformDepth, EnumerationSession *Session) {
+  return AR->enumerate(D, Depth, LastTransformDepth, i, Session);
 }
 
 GraphEdge Enumerator::toGraphEdge() const {
-  std::ostringstream OSS;
-  OSS << "Index " << i;
-  return GraphEdge(AR, OSS.str());
+  return GraphEdge(AR, GraphEdge::INDEX, 0, 0, i);
 }
 
 void Enumerator::writeFormula(const DebugInfo &DI, raw_ostream &OS) const {
@@ -14,7 +14,7 @@
 #ifndef ENUMERATOR_H
 #define ENUMERATOR_H
 
-#include <cstddef>
+#include "llvm/Support/DataTypes.h"
 
 namespace llvm {
 
@@ -26,24 +26,27 @@ namespace llvm {
 namespace andersen_internal {
 
 class AnalysisResult;
+class Data;
 class DebugInfo;
 class EnumerationResult;
+class EnumerationSession;
 class GraphEdge;
 
 class Enumerator {
   AnalysisResult *AR;
-  size_t i;
+  uint32_t i;
 
 public:
-  explicit Enumerator(AnalysisResult *AR, size_t i = 0) : AR(AR), i(i) {}
+  explicit Enumerator(AnalysisResult *AR, uint32_t i = 0) : AR(AR), i(i) {}
 
-  EnumerationResult enumerate(int Depth, int LastTransformDepth);
+  EnumerationResult enumerate(Data &D, int Depth, int LastTransformDepth,
+                              EnumerationSession *Session);
   GraphEdge toGraphEdge() const;
   void writeFormula(const DebugInfo &DI, raw_ostream &OS) const;
 
   AnalysisResult *getAnalysisResult() const { return AR; }
 
-  size_t getPosition() const { return i; }
+  uint32_t getPosition() const { return i; }
 };
 
 }
@@ -0,0 +1,212 @@
+//===- FinishedSet.cpp - compact representation of finished sets ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines an immutable, compact representation of the contents of
+// an AnalysisResult that has finished enumerating, optimized for intersection
+// tests.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FinishedSet.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+// Above this size ratio, galloping through the larger array beats a merge.
+const size_t GallopingRatio = 32;
+
+bool intersectsGalloping(const uint32_t *Small, size_t SmallSize,
+                         const uint32_t *Large, size_t LargeSize) {
+  size_t Lo = 0;
+  for (size_t i = 0; i < SmallSize; ++i) {
+    uint32_t Id = Small[i];
+    // Exponential search for the first element >= Id, then binary search
+    // within the last step.
+    size_t Step = 1;
+    size_t Hi = Lo;
+    while (Hi < LargeSize && Large[Hi] < Id) {
+      Lo = Hi + 1;
+      Hi += Step;
+      Step *= 2;
+    }
+    if (Hi > LargeSize) {
+      Hi = LargeSize;
+    }
+    Lo = std::lower_bound(Large + Lo, Large + Hi, Id) - Large;
+    if (Lo == LargeSize) {
+      return false;
+    }
+    if (Large[Lo] == Id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool intersectsMerge(const uint32_t *A, size_t ASize,
+                     const uint32_t *B, size_t BSize) {
+  size_t i = 0, j = 0;
+#if defined(__SSE2__)
+  // Compare blocks of four against blocks of four, using the three rotations
+  // of one block to cover all sixteen pairs, and advance whichever block has
+  // the smaller maximum.
+  while (i + 4 <= ASize && j + 4 <= BSize) {
+    __m128i VA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(A + i));
+    __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(B + j));
+    __m128i Eq = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi32(VA, VB),
+                     _mm_cmpeq_epi32(VA, _mm_shuffle_epi32(VB, 0x39))),
+        _mm_or_si128(_mm_cmpeq_epi32(VA, _mm_shuffle_epi32(VB, 0x4E)),
+                     _mm_cmpeq_epi32(VA, _mm_shuffle_epi32(VB, 0x93))));
+    if (_mm_movemask_epi8(Eq)) {
+      return true;
+    }
+    uint32_t MaxA = A[i + 3], MaxB = B[j + 3];
+    if (MaxA <= MaxB) {
+      i += 4;
+    }
+    if (MaxB <= MaxA) {
+      j += 4;
+    }
+  }
+#endif
+  while (i < ASize && j < BSize) {
+    if (A[i] < B[j]) {
+      ++i;
+    } else if (B[j] < A[i]) {
+      ++j;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool intersectsSorted(const std::vector<uint32_t> &A,
+                      const std::vector<uint32_t> &B) {
+  if (A.empty() || B.empty()) {
+    return false;
+  }
+  // Cheap rejection if the ranges don't overlap.
+  if (A.back() < B.front() || B.back() < A.front()) {
+    return false;
+  }
+  const std::vector<uint32_t> &Small = A.size() <= B.size() ? A : B;
+  const std::vector<uint32_t> &Large = A.size() <= B.size() ? B : A;
+  if (Large.size() / Small.size() >= GallopingRatio) {
+    return intersectsGalloping(&Small[0], Small.size(),
+                               &Large[0], Large.size());
+  }
+  return intersectsMerge(&A[0], A.size(), &B[0], B.size());
+}
+
+}
+
+FinishedSet::FinishedSet(std::vector<uint32_t> &Ids, uint32_t NumValueInfos,
+                         const FinishedSet *Universe, bool ContainsUniverse)
+  : IsBitmap(false), Size(0), Universe(0) {
+  assert(!ContainsUniverse || Universe);
+  if (Universe && !Universe->containsUniverse() && Universe->Size &&
+      (ContainsUniverse || Universe->Size <= Ids.size())) {
+    // Split off the elements of the universe. If all of them are present then
+    // only the remainder needs to be stored.
+    std::vector<uint32_t> Remainder;
+    for (std::vector<uint32_t>::const_iterator i = Ids.begin(),
+                                               End = Ids.end();
+         i != End; ++i) {
+      if (!Universe->contains(*i)) {
+        Remainder.push_back(*i);
+      }
+    }
+    if (ContainsUniverse || Ids.size() - Remainder.size() == Universe->Size) {
+      this->Universe = Universe;
+      Ids.swap(Remainder);
+    }
+  }
+  Size = Ids.size();
+  IsBitmap = uint64_t(Size) * 32 >= NumValueInfos && Size;
+  if (IsBitmap) {
+    Bitmap.resize((NumValueInfos + 63) / 64);
+    for (std::vector<uint32_t>::const_iterator i = Ids.begin(),
+                                               End = Ids.end();
+         i != End; ++i) {
+      assert(*i < NumValueInfos);
+      Bitmap[*i / 64] |= uint64_t(1) << (*i % 64);
+    }
+  } else {
+    SortedIds.swap(Ids);
+    std::sort(SortedIds.begin(), SortedIds.end());
+  }
+}
+
+bool FinishedSet::contains(uint32_t Id) const {
+  if (Universe && Universe->contains(Id)) {
+    return true;
+  }
+  if (IsBitmap) {
+    return testBit(Id);
+  }
+  return std::binary_search(SortedIds.begin(), SortedIds.end(), Id);
+}
+
+bool FinishedSet::intersects(const FinishedSet &that) const {
+  if (Universe || that.Universe) {
+    if (Universe && that.Universe) {
+      // Both contain the same non-empty universe (there is only one per
+      // Data).
+      assert(Universe == that.Universe);
+      return true;
+    }
+    // The universe is never itself represented with an implicit universe, so
+    // this recursion is at most one level deep.
+    const FinishedSet &Large = Universe ? *this : that;
+    const FinishedSet &Other = Universe ? that : *this;
+    return Large.Universe->intersects(Other) ||
+           Large.intersectsExplicit(Other);
+  }
+  return intersectsExplicit(that);
+}
+
+bool FinishedSet::intersectsExplicit(const FinishedSet &that) const {
+  if (IsBitmap && that.IsBitmap) {
+    // Bitmaps may differ in length if they were built at different times.
+    for (size_t i = 0, End = std::min(Bitmap.size(), that.Bitmap.size());
+         i != End; ++i) {
+      if (Bitmap[i] & that.Bitmap[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+  if (IsBitmap || that.IsBitmap) {
+    const FinishedSet &Dense = IsBitmap ? *this : that;
+    const FinishedSet &Sparse = IsBitmap ? that : *this;
+    for (std::vector<uint32_t>::const_iterator i = Sparse.SortedIds.begin(),
+                                               End = Sparse.SortedIds.end();
+         i != End; ++i) {
+      if (Dense.testBit(*i)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return intersectsSorted(SortedIds, that.SortedIds);
+}
+
+}
+}
@@ -0,0 +1,65 @@
+//===- FinishedSet.h - compact representation of finished sets ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares an immutable, compact representation of the contents of
+// an AnalysisResult that has finished enumerating, optimized for intersection
+// tests.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FINISHEDSET_H
+#define FINISHEDSET_H
+
+#include "llvm/Support/DataTypes.h"
+
+#include <vector>
+
+namespace llvm {
+namespace andersen_internal {
+
+class FinishedSet {
+  // Exactly one of these is in use. Sets that are dense enough over the space
+  // of ValueInfo ids that a bitmap is no larger than a sorted id array are
+  // stored as a bitmap; all others are stored as a sorted id array.
+  std::vector<uint32_t> SortedIds;
+  std::vector<uint64_t> Bitmap;
+  bool IsBitmap;
+  // Number of elements stored above.
+  size_t Size;
+  // If non-null, this set is a superset of Universe and the above only stores
+  // the elements that are not in it.
+  const FinishedSet *Universe;
+
+public:
+  // Takes the contents of Ids, which must be unique and all less than
+  // NumValueInfos. If Universe is non-null and every one of its elements is in
+  // Ids, they are represented implicitly. If ContainsUniverse, the set is Ids
+  // together with all of Universe, whether or not Ids lists its elements.
+  FinishedSet(std::vector<uint32_t> &Ids, uint32_t NumValueInfos,
+              const FinishedSet *Universe = 0, bool ContainsUniverse = false);
+
+  bool contains(uint32_t Id) const;
+  bool intersects(const FinishedSet &that) const;
+
+  bool containsUniverse() const { return Universe; }
+
+private:
+  // Like intersects(), but ignoring any implicit universe in this set or that.
+  bool intersectsExplicit(const FinishedSet &that) const;
+
+  bool testBit(uint32_t Id) const {
+    size_t Word = Id / 64;
+    return Word < Bitmap.size() && ((Bitmap[Word] >> (Id % 64)) & 1);
+  }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,59 @@
+//===- GraphNode.cpp - graph viewing --------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the labels of graph edges.
+//
+//===----------------------------------------------------------------------===//
+
+#include "GraphNode.h"
+
+#include "AlgorithmId.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace andersen_internal {
+
+void GraphEdge::printLabel(raw_ostream &OS) const {
+  switch (Kind) {
+  case NONE:
+    break;
+
+  case RESULT:
+    OS << "PointsTo(";
+    Id->printAlgorithmName(OS);
+    OS << ')';
+    break;
+
+  case ELEMENT:
+    OS << Pos;
+    break;
+
+  case SUBSET:
+    OS << Pos << ": Recurse from index " << Index;
+    break;
+
+  case TRANSFORM:
+    OS << Pos << ": Transform(";
+    Id->printAlgorithmName(OS);
+    OS << ") from index " << Index;
+    break;
+
+  case INDEX:
+    OS << "Index " << Index;
+    break;
+
+  default:
+    llvm_unreachable("Not a recognized LabelKind");
+    break;
+  }
+}
+
+}
+}
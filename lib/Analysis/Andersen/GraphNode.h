@@ -14,9 +14,10 @@
 #ifndef GRAPHNODE_H
 #define GRAPHNODE_H
 
-#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
 
-#include <deque>
+#include <cstddef>
 
 namespace llvm {
 
@@ -27,23 +28,57 @@ class raw_ostream;
 namespace llvm {
 namespace andersen_internal {
 
+class AlgorithmId;
+class Data;
 class DebugInfo;
 class GraphNode;
 
-struct GraphEdge {
-  GraphEdge() : Dst(0) {}
-  GraphEdge(const GraphNode *Dst, StringRef Label)
-    : Dst(Dst), Label(Label.str()) {}
+// An edge of the graph. The label is kept unformatted, so that edges cost no
+// allocation and the label is only printed when the edge is output.
+class GraphEdge {
+public:
+  enum LabelKind {
+    // No label.
+    NONE,
+    // From a VI to its result of algorithm Id.
+    RESULT,
+    // From an AR to its set element at Pos.
+    ELEMENT,
+    // From an AR to the input of its subset work at Pos, read from Index.
+    SUBSET,
+    // Likewise for transform work applying algorithm Id.
+    TRANSFORM,
+    // From an enumerator to its AR, read from Index.
+    INDEX
+  };
 
+private:
   const GraphNode *Dst;
-  std::string Label;
+  const AlgorithmId *Id;
+  size_t Pos;
+  uint32_t Index;
+  LabelKind Kind;
+
+public:
+  GraphEdge(const GraphNode *Dst, LabelKind Kind, const AlgorithmId *Id = 0,
+            size_t Pos = 0, uint32_t Index = 0)
+    : Dst(Dst), Id(Id), Pos(Pos), Index(Index), Kind(Kind) {}
+
+  const GraphNode *getDestination() const { return Dst; }
+  LabelKind getLabelKind() const { return Kind; }
+  // The algorithm of RESULT and TRANSFORM edges.
+  const AlgorithmId *getAlgorithmId() const { return Id; }
+
+  void printLabel(raw_ostream &OS) const;
 };
 
-typedef std::deque<GraphEdge> GraphEdgeDeque;
+typedef SmallVectorImpl<GraphEdge> GraphEdgeVector;
 
 class GraphNode {
 public:
-  virtual GraphEdgeDeque getOutgoingEdges() const = 0;
+  // Append the edges out of this node, which belongs to D, to Edges.
+  virtual void getOutgoingEdges(const Data &D,
+                                GraphEdgeVector &Edges) const = 0;
   virtual void printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const = 0;
   virtual bool isNodeHidden() const = 0;
 
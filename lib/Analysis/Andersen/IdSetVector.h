@@ -0,0 +1,96 @@
+//===- IdSetVector.h - insertion-ordered sets of ids ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a set of 32-bit ids that keeps the order of insertion.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef IDSETVECTOR_H
+#define IDSETVECTOR_H
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace llvm {
+namespace andersen_internal {
+
+// Like SetVector, but for ids, which take half the space of pointers on 64-bit
+// hosts. Sets of up to SmallSize ids are searched by a linear scan and have no
+// hash table. Ids must be less than ~0U - 1, which DenseSet reserves.
+template<typename VectorTy, unsigned SmallSize>
+class IdSetVector {
+  VectorTy Vector;
+  // Index of the elements of Vector. Empty until it has more than SmallSize.
+  DenseSet<uint32_t> Index;
+
+public:
+  typedef typename VectorTy::const_iterator const_iterator;
+
+  bool empty() const { return Vector.empty(); }
+
+  size_t size() const { return Vector.size(); }
+
+  const_iterator begin() const { return Vector.begin(); }
+
+  const_iterator end() const { return Vector.end(); }
+
+  uint32_t operator[](size_t i) const {
+    assert(i < Vector.size());
+    return Vector[i];
+  }
+
+  bool count(uint32_t Id) const {
+    if (Vector.size() <= SmallSize) {
+      return std::find(Vector.begin(), Vector.end(), Id) != Vector.end();
+    }
+    return Index.count(Id);
+  }
+
+  // Returns false if Id was already in the set.
+  bool insert(uint32_t Id) {
+    if (Vector.size() < SmallSize) {
+      if (std::find(Vector.begin(), Vector.end(), Id) != Vector.end()) {
+        return false;
+      }
+      Vector.push_back(Id);
+      return true;
+    }
+    if (Vector.size() == SmallSize) {
+      // Too big for a linear scan from now on.
+      if (std::find(Vector.begin(), Vector.end(), Id) != Vector.end()) {
+        return false;
+      }
+      Index.insert(Vector.begin(), Vector.end());
+    }
+    if (!Index.insert(Id).second) {
+      return false;
+    }
+    Vector.push_back(Id);
+    return true;
+  }
+
+  void clear() {
+    Vector.clear();
+    Index.clear();
+  }
+
+  void swap(IdSetVector &that) {
+    Vector.swap(that.Vector);
+    Index.swap(that.Index);
+  }
+};
+
+}
+}
+
+#endif
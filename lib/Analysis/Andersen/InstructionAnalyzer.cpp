@@ -11,38 +11,109 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "andersen"
 #include "InstructionAnalyzer.h"
 
+#include "AnalysisResult.h"
+#include "Components.h"
+#include "CostAttribution.h"
 #include "Data.h"
+#include "Derivations.h"
 #include "RelationHandler.h"
 #include "PointsToAlgorithm.h"
+#include "RelationStore.h"
 #include "RelationType.h"
+#include "ReversePointsToAlgorithm.h"
+#include "StoredValuesPointsToAlgorithm.h"
+#include "Unification.h"
 #include "ValueInfo.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
-#include "llvm/Analysis/Dominators.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/User.h"
 #include "llvm/IR/Value.h"
 #include "llvm/InstVisitor.h"
-#include "llvm/Pass.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/ErrorHandling.h"
 
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace llvm {
 namespace andersen_internal {
 
+STATISTIC(NumDeferredInitializers, "Number of global initializers deferred");
+STATISTIC(NumLateInitializers,
+          "Number of deferred global initializers analyzed when needed");
+STATISTIC(NumDematerialized,
+          "Number of function bodies discarded after analysis");
+
+namespace {
+
+// Whether G is defined in this module. Functions of a lazily read module whose
+// bodies have not been read in yet look like declarations.
+bool isDefinition(const GlobalValue *G) {
+  return !G->isDeclaration() || G->isMaterializable();
+}
+
+}
+
 class InstructionAnalyzer::Visitor
-  : public InstVisitor<InstructionAnalyzer::Visitor> {
+  : public InstVisitor<InstructionAnalyzer::Visitor>,
+    public DeferredRelations {
   typedef SmallVector<std::pair<const PHINode *, ValueInfo *>, 3>
       PHINodeWorkVector;
-  ModulePass *const MP;
+  typedef ReversePostOrderTraversal<Function *> BlockOrder;
+  typedef std::map<std::vector<ValueInfo *>, ValueInfo *> ConstantVIMap;
+  typedef DenseMap<const ValueInfo *, SmallVector<const Value *, 1> >
+      SharedVIMap;
+  typedef DenseMap<const GlobalVariable *, ValueInfo *> InitializerMap;
+  Module &M;
+  // Null if not unifying.
+  Unification *U;
   PHINodeWorkVector PHINodeWork;
   Function *CurrentFunction;
+  // The reachable blocks of CurrentFunction.
+  BlockOrder *CurrentBlockOrder;
+  // Where newly analyzed Values go: ValueInfos during instruction analysis,
+  // and InitializerValueInfos for deferred initializers afterwards.
+  ValueInfoMap *Cache;
+  // The VIs of constants with several pointer operands, by the sorted VIs of
+  // those operands. Constants with the same operands, like the entries of a
+  // table that only differ in their other fields, share one VI.
+  ConstantVIMap ConstantValueInfos;
+  // The constants sharing each VI other than its own Value. Only kept if
+  // initializers are deferred.
+  SharedVIMap SharedConstants;
+  const bool DeferInitializers;
+  // Global variables whose initializer is still to be analyzed, with their
+  // region VI.
+  InitializerMap PendingInitializers;
+  // Globals that map to ExternallyLinkableRegions. Only kept if initializers
+  // are deferred.
+  SmallVector<const GlobalValue *, 8> ExternalGlobals;
 
 public:
   Data *const D;
 
-  Visitor(ModulePass *MP, Module &M)
-    : MP(MP), D(createData()) {
+  Visitor(Module &M, Unification *U, bool FindComponents, bool LazyRelations,
+          bool LazyInitializers, bool Dematerialize)
+    : M(M), U(U), CurrentFunction(0), CurrentBlockOrder(0),
+      DeferInitializers(LazyInitializers && LazyRelations && !FindComponents),
+      D(new Data()) {
+    Cache = &D->ValueInfos;
+    if (FindComponents) {
+      D->Comps = new Components(D->ExternallyLinkableRegions.getPtr(),
+                                D->ExternallyAccessibleRegions.getPtr());
+    }
+    if (LazyRelations) {
+      D->Relations = new RelationStore();
+    }
+    analyzeExternalRegions();
     for (Module::global_iterator i = M.global_begin(), End = M.global_end();
          i != End; ++i) {
       analyzeValue(&*i);
@@ -54,12 +125,99 @@ public:
     for (Module::iterator i = M.begin(), End = M.end(); i != End; ++i) {
       Function &F(*i);
       analyzeValue(&F);
-      if (!F.isDeclaration()) {
-        processFunction(F);
+      if (!isDefinition(&F)) {
+        continue;
+      }
+      bool Materialized = F.isMaterializable();
+      if (Materialized) {
+        std::string ErrInfo;
+        if (F.Materialize(&ErrInfo)) {
+          report_fatal_error("Andersen: cannot read in function " +
+                             F.getName() + ": " + ErrInfo);
+        }
+      }
+      processFunction(F);
+      if (Materialized && Dematerialize && F.isDematerializable()) {
+        // Only the VIs are needed from now on, so read in at most one body at
+        // a time.
+        D->forgetFunctionBody(F);
+        F.Dematerialize();
+        ++NumDematerialized;
       }
     }
   }
 
+  bool hasPendingInitializers() const {
+    return !PendingInitializers.empty();
+  }
+
+  // The deferred initializers store the values of globals used by constants
+  // to their regions. Tell U so, since it cannot wait for them.
+  void addPendingInitializersTo(Unification &U) {
+    std::vector<const ValueInfo *> Values;
+    addConstantUsedValueInfos(M.global_begin(), M.global_end(), Values);
+    addConstantUsedValueInfos(M.alias_begin(), M.alias_end(), Values);
+    addConstantUsedValueInfos(M.begin(), M.end(), Values);
+    std::vector<const ValueInfo *> Regions;
+    for (InitializerMap::const_iterator i = PendingInitializers.begin(),
+                                        End = PendingInitializers.end();
+         i != End; ++i) {
+      Regions.push_back(i->second);
+    }
+    U.addUnknownStores(Values, Regions);
+  }
+
+  // Instruction analysis is done, so from now on only analyze the deferred
+  // initializers, into Relations.
+  void finishInstructionAnalysis() {
+    assert(DeferInitializers && D->Relations);
+    U = 0;
+    Cache = &D->InitializerValueInfos;
+  }
+
+  virtual void addRelationsFor(const ValueInfo *VI, const AlgorithmId *Id) {
+    if (PendingInitializers.empty()) {
+      return;
+    }
+    if (Id == &StoredValuesPointsToAlgorithm::ID) {
+      // An initializer stores to the region of its global.
+      if (const GlobalVariable *GV =
+              dyn_cast_or_null<GlobalVariable>(VI->getValue())) {
+        analyzePendingInitializer(GV);
+      }
+    } else if (Id == &ReversePointsToAlgorithm::ID) {
+      // An initializer relates the VIs of the constants in it, which are those
+      // of the constants that use VI's Values, to other VIs.
+      if (VI == D->ExternallyLinkableRegions.getPtr()) {
+        for (SmallVectorImpl<const GlobalValue *>::const_iterator
+                 i = ExternalGlobals.begin(), End = ExternalGlobals.end();
+             i != End; ++i) {
+          analyzeInitializersUsing(*i);
+        }
+        ExternalGlobals.clear();
+        return;
+      }
+      if (const Constant *C = dyn_cast_or_null<Constant>(VI->getValue())) {
+        analyzeInitializersUsing(C);
+      }
+      SharedVIMap::const_iterator i = SharedConstants.find(VI);
+      if (i != SharedConstants.end()) {
+        // Copy, since analysis may add more.
+        SmallVector<const Value *, 4> Shared(i->second.begin(),
+                                             i->second.end());
+        for (SmallVectorImpl<const Value *>::const_iterator
+                 j = Shared.begin(), End = Shared.end();
+             j != End; ++j) {
+          analyzeInitializersUsing(*j);
+        }
+      }
+    }
+  }
+
+  virtual void addRelationsUsing(const Value *V) {
+    analyzeInitializersUsing(V);
+  }
+
   void visitReturnInst(ReturnInst &I) {
     const Value *ReturnValue = I.getReturnValue();
     if (!ReturnValue) {
@@ -68,7 +226,7 @@ public:
     ValueInfo *ReturnedValueInfo = analyzeValue(ReturnValue);
     if (ReturnedValueInfo) {
       ValueInfo *FunctionValueInfo = getGlobalRegionInfo(CurrentFunction);
-      RelationHandler::handleRelation<RETURNED_TO_CALLER>(ReturnedValueInfo,
+      handleRelation<RETURNED_TO_CALLER>(ReturnedValueInfo,
           FunctionValueInfo);
     }
   }
@@ -81,7 +239,7 @@ public:
     ValueInfo *AddressAnalysis = analyzeValue(I.getPointerOperand());
     if (AddressAnalysis) {
       ValueInfo *LoadedValueInfo = cacheNewValueInfo(&I);
-      RelationHandler::handleRelation<LOADED_FROM>(LoadedValueInfo,
+      handleRelation<LOADED_FROM>(LoadedValueInfo,
           AddressAnalysis);
     } else {
       cacheNil(&I);
@@ -93,7 +251,7 @@ public:
     ValueInfo *AddressAnalysis = analyzeValue(I.getPointerOperand());
     ValueInfo *StoredValueInfo = analyzeValue(I.getValueOperand());
     if (AddressAnalysis && StoredValueInfo) {
-      RelationHandler::handleRelation<STORED_TO>(StoredValueInfo,
+      handleRelation<STORED_TO>(StoredValueInfo,
           AddressAnalysis);
       // TODO: Record that the current function may store this address.
     }
@@ -141,14 +299,14 @@ public:
       const Value *ArgumentValue = *i;
       ValueInfo *ArgumentValueInfo = analyzeValue(ArgumentValue);
       if (CalledValueInfo && ArgumentValueInfo) {
-        RelationHandler::handleRelation<ARGUMENT_TO_CALLEE>(ArgumentValueInfo,
+        handleRelation<ARGUMENT_TO_CALLEE>(ArgumentValueInfo,
             CalledValueInfo);
       }
     }
     if (!CS.getType()->isVoidTy()) {
       if (CalledValueInfo) {
         ValueInfo *ReturnedValueInfo = cacheNewValueInfo(CS.getInstruction());
-        RelationHandler::handleRelation<RETURNED_FROM_CALLEE>(ReturnedValueInfo,
+        handleRelation<RETURNED_FROM_CALLEE>(ReturnedValueInfo,
             CalledValueInfo);
       } else {
         cacheNil(CS.getInstruction());
@@ -164,14 +322,14 @@ public:
     // va_list itself. Thus multiply-indirect loads are treated as potentially
     // aliasing them too.
     ValueInfo *ArgumentsVI = createAnonymousValueInfo();
-    RelationHandler::handleRelation<ARGUMENT_FROM_CALLER>(ArgumentsVI,
+    handleRelation<ARGUMENT_FROM_CALLER>(ArgumentsVI,
         getGlobalRegionInfo(CurrentFunction));
     ValueInfo *VAListVI = analyzeValue(I.getArgList());
     if (VAListVI) {
       // Pretend that va_start stores the va_list address to itself.
-      RelationHandler::handleRelation<STORED_TO>(VAListVI, VAListVI);
+      handleRelation<STORED_TO>(VAListVI, VAListVI);
       // Pretend that va_start stores the arguments to the va_list.
-      RelationHandler::handleRelation<STORED_TO>(ArgumentsVI, VAListVI);
+      handleRelation<STORED_TO>(ArgumentsVI, VAListVI);
     }
   }
 
@@ -188,11 +346,11 @@ public:
     if (SrcVI && DestVI) {
       // Pretend that va_copy copies the va_list contents.
       ValueInfo *ContentsVI = createAnonymousValueInfo();
-      RelationHandler::handleRelation<LOADED_FROM>(ContentsVI, SrcVI);
-      RelationHandler::handleRelation<STORED_TO>(ContentsVI, DestVI);
+      handleRelation<LOADED_FROM>(ContentsVI, SrcVI);
+      handleRelation<STORED_TO>(ContentsVI, DestVI);
       // Pretend that it also writes the destination va_list's address to
       // itself.
-      RelationHandler::handleRelation<STORED_TO>(DestVI, DestVI);
+      handleRelation<STORED_TO>(DestVI, DestVI);
     }
   }
 
@@ -204,7 +362,7 @@ public:
       ValueInfo *VAArgVI = cacheNewValueInfo(&I);
       // Pretend that va_arg just reads from the va_list, returning either an
       // argument or the va_list itself.
-      RelationHandler::handleRelation<LOADED_FROM>(VAArgVI, VAListVI);
+      handleRelation<LOADED_FROM>(VAArgVI, VAListVI);
     } else {
       cacheNil(&I);
     }
@@ -224,7 +382,7 @@ public:
     ValueInfo *DestVI = analyzeValue(I.getRawDest());
     ValueInfo *ValueVI = analyzeValue(I.getValue());
     if (DestVI && ValueVI) {
-      RelationHandler::handleRelation<STORED_TO>(ValueVI, DestVI);
+      handleRelation<STORED_TO>(ValueVI, DestVI);
     }
   }
 
@@ -237,14 +395,15 @@ public:
   }
 
 private:
-  static Data *createData() {
+  void analyzeExternalRegions() {
     // All global regions that are externally accessible by way of linkage. This
     // is the set of all internally-defined global regions with external linkage
     // plus a placeholder for all externally-defined global regions. We simply
     // create this as a region so as to use itself as the placeholder. Unlike
     // normal regions, its points-to set will contain both itself and other
     // VIs.
-    ValueInfo *ExternallyLinkableRegions = createRegion(0);
+    ValueInfo *ExternallyLinkableRegions =
+        makeRegion(D->ExternallyLinkableRegions.getPtr());
 
     // All regions that are externally accessible in any manner. This is the
     // members of the above set plus all internally-defined regions that can be
@@ -252,28 +411,77 @@ private:
     // externally-defined functions. (In this context, the placeholder created
     // above also represents externally-defined non-global regions, which are
     // indistinguishable.)
-    ValueInfo *ExternallyAccessibleRegions = createValueInfo(0);
-    RelationHandler::handleRelation<DEPENDS_ON>(ExternallyAccessibleRegions,
+    ValueInfo *ExternallyAccessibleRegions =
+        D->ExternallyAccessibleRegions.getPtr();
+    handleRelation<DEPENDS_ON>(ExternallyAccessibleRegions,
         ExternallyLinkableRegions);
     // Putting ExternallyAccessibleRegions into every relation with itself makes
     // it expand to what we want.
-    RelationHandler::handleRelation<ARGUMENT_TO_CALLEE>(
+    handleRelation<ARGUMENT_TO_CALLEE>(
         ExternallyAccessibleRegions, ExternallyAccessibleRegions);
-    RelationHandler::handleRelation<LOADED_FROM>(
+    handleRelation<LOADED_FROM>(
         ExternallyAccessibleRegions, ExternallyAccessibleRegions);
-    RelationHandler::handleRelation<RETURNED_FROM_CALLEE>(
+    handleRelation<RETURNED_FROM_CALLEE>(
         ExternallyAccessibleRegions, ExternallyAccessibleRegions);
-    RelationHandler::handleRelation<STORED_TO>(
+    handleRelation<STORED_TO>(
         ExternallyAccessibleRegions, ExternallyAccessibleRegions);
     // Special case for the function definition relations, which only work for
     // region VIs. Here ExternallyLinkableRegions represents externally-defined
     // functions.
-    RelationHandler::handleRelation<ARGUMENT_FROM_CALLER>(
+    handleRelation<ARGUMENT_FROM_CALLER>(
         ExternallyAccessibleRegions, ExternallyLinkableRegions);
-    RelationHandler::handleRelation<RETURNED_TO_CALLER>(
+    handleRelation<RETURNED_TO_CALLER>(
         ExternallyAccessibleRegions, ExternallyLinkableRegions);
+  }
+
+  template<typename IteratorTy>
+  void addConstantUsedValueInfos(IteratorTy Begin, IteratorTy End,
+                                 std::vector<const ValueInfo *> &Values) {
+    for (IteratorTy i = Begin; i != End; ++i) {
+      const GlobalValue *G = &*i;
+      // Only constants can be in an initializer, so any other use is fine.
+      bool ConstantUse = false;
+      for (Value::const_use_iterator j = G->use_begin(), UseEnd = G->use_end();
+           j != UseEnd && !ConstantUse; ++j) {
+        ConstantUse = !isa<Instruction>(*j);
+      }
+      if (ConstantUse) {
+        if (ValueInfo *VI = D->ValueInfos.lookup(G).getPtr()) {
+          Values.push_back(VI);
+        }
+      }
+    }
+  }
 
-    return new Data(ExternallyLinkableRegions, ExternallyAccessibleRegions);
+  void analyzePendingInitializer(const GlobalVariable *GV) {
+    InitializerMap::iterator i = PendingInitializers.find(GV);
+    if (i == PendingInitializers.end()) {
+      return;
+    }
+    ValueInfo *RegionVI = i->second;
+    PendingInitializers.erase(i);
+    ++NumLateInitializers;
+    analyzeInitializer(GV, RegionVI);
+  }
+
+  // Analyze the pending initializers that contain V.
+  void analyzeInitializersUsing(const Value *V) {
+    SmallVector<const Value *, 8> Worklist(1, V);
+    SmallPtrSet<const Value *, 16> Visited;
+    while (!Worklist.empty()) {
+      const Value *Used = Worklist.pop_back_val();
+      for (Value::const_use_iterator i = Used->use_begin(),
+                                     End = Used->use_end();
+           i != End; ++i) {
+        const User *U = *i;
+        if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(U)) {
+          analyzePendingInitializer(GV);
+        } else if (isa<Constant>(U) && !isa<GlobalValue>(U) &&
+                   Visited.insert(U)) {
+          Worklist.push_back(U);
+        }
+      }
+    }
   }
 
   void processFunction(Function &F) {
@@ -282,13 +490,15 @@ private:
          ++i) {
       analyzeValue(&*i);
     }
-    // Visit the basic blocks in a depth-first traversal of the dominator tree.
-    // This ensures that we visit each instruction before each non-PHI use of
-    // it.
-    DomTreeNode *Root = MP->getAnalysis<DominatorTree>(F).getRootNode();
-    for (df_iterator<DomTreeNode *> i = df_begin(Root), End = df_end(Root);
+    // Visit the basic blocks in reverse post-order of the CFG. A block comes
+    // after all blocks that dominate it, so this ensures that we visit each
+    // instruction before each non-PHI use of it without computing dominators.
+    // Uses by PHI nodes may still come first, so those are deferred.
+    BlockOrder RPOT(&F);
+    CurrentBlockOrder = &RPOT;
+    for (BlockOrder::rpo_iterator i = RPOT.begin(), End = RPOT.end();
          i != End; ++i) {
-      visit(i->getBlock());
+      visit(*i);
     }
     // Process all the PHI nodes.
     for (PHINodeWorkVector::const_iterator i = PHINodeWork.begin(),
@@ -300,36 +510,73 @@ private:
            i != End; ++i) {
         ValueInfo *OperandAnalysis = analyzeValue(*i);
         if (OperandAnalysis) {
-          RelationHandler::handleRelation<DEPENDS_ON>(PHIAnalysis,
+          handleRelation<DEPENDS_ON>(PHIAnalysis,
               OperandAnalysis);
         }
       }
     }
     PHINodeWork.clear();
+    CurrentBlockOrder = 0;
   }
 
   bool analyzed(const Value *V) {
-    return D->ValueInfos.count(V);
+    return D->ValueInfos.count(V) || Cache->count(V);
   }
 
-  static ValueInfo *makeRegion(ValueInfo *VI) {
-    VI->getAlgorithmResult<PointsToAlgorithm, INSTRUCTION_ANALYSIS_PHASE>()
-        ->addValueInfo(VI);
+  ValueInfo *makeRegion(ValueInfo *VI) {
+    if (D->Relations) {
+      D->Relations->addRegion(VI);
+    } else {
+      VI->getAlgorithmResult<PointsToAlgorithm, INSTRUCTION_ANALYSIS_PHASE>()
+          ->addValueInfo(VI);
+    }
+    if (U) {
+      U->addRegion(VI);
+    }
     return VI;
   }
 
-  static ValueInfo *createValueInfo(const Value *V) {
-    return new ValueInfo(V);
+  template<RelationType RT>
+  void handleRelation(ValueInfo *Src, ValueInfo *Dst) {
+    if (CostAttribution *C = CostAttribution::getActive()) {
+      C->tagRelation(RT, Src, Dst, CurrentFunction);
+    }
+    if (Derivations *Derivs = Derivations::getActive()) {
+      Derivs->setCurrentRelation(RT, Src, Dst);
+    }
+    if (D->Relations) {
+      D->Relations->addRelation(RT, Src, Dst);
+    } else {
+      RelationHandler::handleRelation<RT>(Src, Dst);
+    }
+    if (U) {
+      U->addRelation(RT, Src, Dst);
+    }
+    if (D->Comps) {
+      D->Comps->addRelation(Src, Dst);
+    }
+  }
+
+  ValueInfo *createValueInfo(const Value *V) {
+    ValueInfo *VI = D->createValueInfo(V);
+    if (D->Comps) {
+      D->Comps->addValueInfo(VI);
+    }
+    if (Cache != &D->ValueInfos) {
+      // The relations are already indexed.
+      D->Relations->addValueInfo(VI);
+    }
+    return VI;
   }
 
-  static ValueInfo *createRegion(const Value *V) {
+  ValueInfo *createRegion(const Value *V) {
     return makeRegion(createValueInfo(V));
   }
 
   ValueInfo *cache(const Value *V, ValueInfo *VI) {
     assert(V);
     assert(!analyzed(V));
-    D->ValueInfos[V] = VI;
+    (*Cache)[V] = VI;
     return VI;
   }
 
@@ -346,7 +593,7 @@ private:
   }
 
   ValueInfo *getGlobalRegionInfo(const GlobalValue *G) {
-    assert(!G->isDeclaration());
+    assert(isDefinition(G));
     assert(!isa<GlobalAlias>(G));
     ValueInfo::Ref &VI = D->GlobalRegionInfos[G];
     ValueInfo *Out;
@@ -372,6 +619,12 @@ private:
       // Previously analyzed.
       return i->second.getPtr();
     }
+    if (Cache != &D->ValueInfos) {
+      i = Cache->find(V);
+      if (i != Cache->end()) {
+        return i->second.getPtr();
+      }
+    }
     // Else analyze now.
     ValueInfo *VI;
     if (const GlobalValue *G = dyn_cast<GlobalValue>(V)) {
@@ -384,8 +637,9 @@ private:
       // reachable BB has a PHI node with an incoming value from an unreachable
       // BB. Since the instruction cannot possibly execute, we can pretend that
       // its result points to nothing.
-      assert(!MP->getAnalysis<DominatorTree>(*CurrentFunction)
-                 .isReachableFromEntry(I->getParent()) &&
+      assert(CurrentBlockOrder &&
+             std::find(CurrentBlockOrder->begin(), CurrentBlockOrder->end(),
+                       I->getParent()) == CurrentBlockOrder->end() &&
              "Instruction used before executed");
       VI = cacheNil(V);
     } else if (const User *U = dyn_cast<User>(V)) {
@@ -398,8 +652,11 @@ private:
   }
 
   ValueInfo *analyzeGlobalValue(const GlobalValue *G) {
-    if (G->isDeclaration()) {
+    if (!isDefinition(G)) {
       assert(!G->hasLocalLinkage());  // Verifier ensures this
+      if (DeferInitializers) {
+        ExternalGlobals.push_back(G);
+      }
       return cache(G, D->ExternallyLinkableRegions.getPtr());
     } else {
       ValueInfo *VI;
@@ -410,7 +667,7 @@ private:
         VI = analyzeGlobalRegion(G);
       }
       if (VI && !G->hasLocalLinkage()) {
-        RelationHandler::handleRelation<DEPENDS_ON>(
+        handleRelation<DEPENDS_ON>(
             D->ExternallyLinkableRegions.getPtr(), VI);
       }
       return VI;
@@ -423,14 +680,17 @@ private:
       // Even when not overridable, we have to make a new ValueInfo because
       // alias chains can have cycles.
       ValueInfo *VI = cacheNewValueInfo(GA);
-      RelationHandler::handleRelation<DEPENDS_ON>(VI, analyzeValue(Aliasee));
+      handleRelation<DEPENDS_ON>(VI, analyzeValue(Aliasee));
       if (GA->mayBeOverridden()) {
-        RelationHandler::handleRelation<DEPENDS_ON>(
+        handleRelation<DEPENDS_ON>(
             VI, D->ExternallyLinkableRegions.getPtr());
       }
       return VI;
     } else if (GA->mayBeOverridden()) {
       // TODO: What does it mean for an alias to alias nothing?
+      if (DeferInitializers) {
+        ExternalGlobals.push_back(GA);
+      }
       return cache(GA, D->ExternallyLinkableRegions.getPtr());
     } else {
       // TODO: What does it mean for an alias to alias nothing?
@@ -444,8 +704,8 @@ private:
     if (G->mayBeOverridden()) {
       // It either points to this region or an externally-linkable region.
       VI = cacheNewValueInfo(G);
-      RelationHandler::handleRelation<DEPENDS_ON>(VI, RegionVI);
-      RelationHandler::handleRelation<DEPENDS_ON>(
+      handleRelation<DEPENDS_ON>(VI, RegionVI);
+      handleRelation<DEPENDS_ON>(
           VI, D->ExternallyLinkableRegions.getPtr());
     } else {
       // It can only point to this region.
@@ -453,22 +713,37 @@ private:
     }
     if (const GlobalVariable *GV = dyn_cast<GlobalVariable>(G)) {
       assert(GV->hasInitializer());
-      ValueInfo *InitializerValueInfo = analyzeValue(GV->getInitializer());
-      if (InitializerValueInfo) {
-        // Since Andersen's algorithm is flow-insensitive, the effect of an
-        // initializer is the same as that of a store instruction, except that
-        // it can only store to the definition of the symbol in this module.
-        RelationHandler::handleRelation<STORED_TO>(InitializerValueInfo,
-            RegionVI);
+      // Aggregates and constant expressions can be large, so if possible they
+      // are only analyzed once a result needs them.
+      if (DeferInitializers && GV->getInitializer()->getNumOperands()) {
+        PendingInitializers[GV] = RegionVI;
+        ++NumDeferredInitializers;
+      } else {
+        analyzeInitializer(GV, RegionVI);
       }
     }
     return VI;
   }
 
+  void analyzeInitializer(const GlobalVariable *GV, ValueInfo *RegionVI) {
+    // The relations belong to no function, even if a use in one led here.
+    Function *SavedFunction = CurrentFunction;
+    CurrentFunction = 0;
+    ValueInfo *InitializerValueInfo = analyzeValue(GV->getInitializer());
+    if (InitializerValueInfo) {
+      // Since Andersen's algorithm is flow-insensitive, the effect of an
+      // initializer is the same as that of a store instruction, except that
+      // it can only store to the definition of the symbol in this module.
+      handleRelation<STORED_TO>(InitializerValueInfo,
+          RegionVI);
+    }
+    CurrentFunction = SavedFunction;
+  }
+
   ValueInfo *analyzeArgument(const Argument *A) {
     ValueInfo *ArgumentValueInfo = cacheNewValueInfo(A);
     ValueInfo *FunctionValueInfo = getGlobalRegionInfo(CurrentFunction);
-    RelationHandler::handleRelation<ARGUMENT_FROM_CALLER>(ArgumentValueInfo,
+    handleRelation<ARGUMENT_FROM_CALLER>(ArgumentValueInfo,
         FunctionValueInfo);
     return ArgumentValueInfo;
   }
@@ -476,10 +751,11 @@ private:
   ValueInfo *analyzeUser(const User *U) {
     typedef SmallVector<ValueInfo *, 3> ValueInfoVector;
     ValueInfoVector Set;
+    SmallPtrSet<ValueInfo *, 4> Seen;
     for (User::const_op_iterator i = U->op_begin(), End = U->op_end(); i != End;
          ++i) {
       ValueInfo *VI = analyzeValue(*i);
-      if (VI) {
+      if (VI && Seen.insert(VI)) {
         Set.push_back(VI);
       }
     }
@@ -491,14 +767,26 @@ private:
     case 1:
       Result = cache(U, Set.front());
       break;
-    default:
+    default: {
+      std::vector<ValueInfo *> Key(Set.begin(), Set.end());
+      std::sort(Key.begin(), Key.end());
+      ValueInfo *&Shared = ConstantValueInfos[Key];
+      if (Shared) {
+        Result = cache(U, Shared);
+        if (DeferInitializers) {
+          SharedConstants[Shared].push_back(U);
+        }
+        break;
+      }
       Result = cacheNewValueInfo(U);
+      Shared = Result;
       for (ValueInfoVector::const_iterator i = Set.begin(), End = Set.end();
            i != Set.end(); ++i) {
-        RelationHandler::handleRelation<DEPENDS_ON>(Result, *i);
+        handleRelation<DEPENDS_ON>(Result, *i);
       }
       break;
     }
+    }
     return Result;
   }
 
@@ -508,10 +796,10 @@ private:
     ValueInfo *StoredValueInfo = analyzeValue(ValOperand);
     if (AddressAnalysis) {
       ValueInfo *LoadedValueInfo = cacheNewValueInfo(&I);
-      RelationHandler::handleRelation<LOADED_FROM>(LoadedValueInfo,
+      handleRelation<LOADED_FROM>(LoadedValueInfo,
           AddressAnalysis);
       if (StoredValueInfo) {
-        RelationHandler::handleRelation<STORED_TO>(StoredValueInfo,
+        handleRelation<STORED_TO>(StoredValueInfo,
             AddressAnalysis);
       }
     } else {
@@ -526,14 +814,71 @@ private:
     ValueInfo *SrcVI = analyzeValue(I.getRawSource());
     if (DestVI && SrcVI) {
       ValueInfo *LoadVI = createAnonymousValueInfo();
-      RelationHandler::handleRelation<LOADED_FROM>(LoadVI, SrcVI);
-      RelationHandler::handleRelation<STORED_TO>(LoadVI, DestVI);
+      handleRelation<LOADED_FROM>(LoadVI, SrcVI);
+      handleRelation<STORED_TO>(LoadVI, DestVI);
     }
   }
 };
 
-Data *InstructionAnalyzer::run(ModulePass *MP, Module &M) {
-  return Visitor(MP, M).D;
+namespace {
+
+void assignUnificationClassVisitor(void *Arg, ValueInfo *VI) {
+  AnalysisResult *AR =
+      VI->getAlgorithmResult<PointsToAlgorithm, ENUMERATION_PHASE>();
+  if (AR) {
+    AR->setUnificationClass(
+        static_cast<Unification *>(Arg)->getPointsToClass(VI));
+  }
+}
+
+struct RecordUnificationClassArg {
+  Unification *U;
+  RelationStore *Relations;
+};
+
+// Like assignUnificationClassVisitor, for the points-to sets still to be built
+// from Relations.
+void recordUnificationClassVisitor(void *Arg, ValueInfo *VI) {
+  RecordUnificationClassArg *RUCA =
+      static_cast<RecordUnificationClassArg *>(Arg);
+  if (RUCA->Relations->hasRelations(VI)) {
+    RUCA->Relations->setUnificationClass(VI, RUCA->U->getPointsToClass(VI));
+  }
+}
+
+}
+
+Data *InstructionAnalyzer::run(Module &M, bool Unify, bool FindComponents,
+                               bool LazyRelations, bool LazyInitializers,
+                               bool Dematerialize) {
+  Unification U;
+  Visitor *V = new Visitor(M, Unify ? &U : 0, FindComponents, LazyRelations,
+                           LazyInitializers, Dematerialize);
+  Data *D = V->D;
+  if (D->Comps) {
+    D->Comps->finish();
+  }
+  if (D->Relations) {
+    D->finishRelations();
+  }
+  if (V->hasPendingInitializers()) {
+    if (Unify) {
+      V->addPendingInitializersTo(U);
+    }
+    V->finishInstructionAnalysis();
+    D->Relations->setDeferredRelations(V);
+  } else {
+    delete V;
+  }
+  if (Unify && D->Relations) {
+    RecordUnificationClassArg RUCA = { &U, D->Relations };
+    D->visitValueInfos(&recordUnificationClassVisitor,
+                       static_cast<void *>(&RUCA));
+  } else if (Unify) {
+    D->visitValueInfos(&assignUnificationClassVisitor,
+                       static_cast<void *>(&U));
+  }
+  return D;
 }
 
 }
@@ -17,7 +17,6 @@
 namespace llvm {
 
 class Module;
-class ModulePass;
 
 }
 
@@ -30,7 +29,18 @@ class InstructionAnalyzer {
   class Visitor;
 
 public:
-  static Data *run(ModulePass *MP, Module &M);
+  // If Unify is set, also assigns the unification classes of the points-to
+  // sets. If FindComponents is set, also decomposes the ValueInfos into the
+  // connected components of their relations. If LazyRelations is set, only
+  // records the relations, and the ARs are built from them when first needed.
+  // If LazyInitializers is also set, the relations of aggregate global
+  // initializers are only added when first needed, unless FindComponents is
+  // set. Function bodies not yet read in from a lazily read module are read
+  // in one at a time, and if Dematerialize is set, discarded again once
+  // analyzed.
+  static Data *run(Module &M, bool Unify, bool FindComponents,
+                   bool LazyRelations, bool LazyInitializers,
+                   bool Dematerialize);
 };
 
 }
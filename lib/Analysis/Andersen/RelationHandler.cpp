@@ -16,14 +16,20 @@
 
 #include "ActualParametersPointsToAlgorithm.h"
 #include "ActualReturnValuePointsToAlgorithm.h"
+#include "CostAttribution.h"
+#include "Derivations.h"
 #include "FormalParametersReversePointsToAlgorithm.h"
 #include "FormalReturnValueReversePointsToAlgorithm.h"
 #include "LoadedValuesReversePointsToAlgorithm.h"
 #include "PointsToAlgorithm.h"
 #include "ReversePointsToAlgorithm.h"
 #include "StoredValuesPointsToAlgorithm.h"
+#include "RelationStore.h"
 #include "TraversalAlgorithm.h"
 #include "ValueInfo.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 
 #include <cassert>
 
@@ -32,6 +38,18 @@ namespace andersen_internal {
 
 namespace {
 
+// Make the result of AlgorithmTy2 for Input a subset of the result of
+// AlgorithmTy1 for Target. If Owner is set, only the results of Owner are being
+// built, so the step is skipped for other Targets.
+template<typename AlgorithmTy1, typename AlgorithmTy2>
+inline void addWork(ValueInfo *Target, ValueInfo *Input,
+                    const ValueInfo *Owner) {
+  if (Owner && Target != Owner) {
+    return;
+  }
+  Target->addInstructionAnalysisWork<AlgorithmTy1, AlgorithmTy2>(Input);
+}
+
 template<typename AlgorithmTy>
 struct ForAlgorithm;
 
@@ -39,171 +57,194 @@ struct ForAlgorithm;
 template<>
 struct ForAlgorithm<ActualParametersPointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<ActualParametersPointsToAlgorithm>
-    ::handleRelation<ARGUMENT_TO_CALLEE>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<ActualParametersPointsToAlgorithm,
-      PointsToAlgorithm>(Src);
+    ::handleRelation<ARGUMENT_TO_CALLEE>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<ActualParametersPointsToAlgorithm,
+          PointsToAlgorithm>(Dst, Src, Owner);
 }
 
 // ActualReturnValuePointsToAlgorithm
 template<>
 struct ForAlgorithm<ActualReturnValuePointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<ActualReturnValuePointsToAlgorithm>
-    ::handleRelation<RETURNED_TO_CALLER>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<ActualReturnValuePointsToAlgorithm,
-      PointsToAlgorithm>(Src);
+    ::handleRelation<RETURNED_TO_CALLER>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<ActualReturnValuePointsToAlgorithm,
+          PointsToAlgorithm>(Dst, Src, Owner);
 }
 
 // FormalParametersReversePointsToAlgorithm
 template<>
 struct ForAlgorithm<FormalParametersReversePointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<FormalParametersReversePointsToAlgorithm>
-    ::handleRelation<ARGUMENT_FROM_CALLER>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<FormalParametersReversePointsToAlgorithm,
-      ReversePointsToAlgorithm>(Src);
+    ::handleRelation<ARGUMENT_FROM_CALLER>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<FormalParametersReversePointsToAlgorithm,
+          ReversePointsToAlgorithm>(Dst, Src, Owner);
 }
 
 // FormalReturnValueReversePointsToAlgorithm
 template<>
 struct ForAlgorithm<FormalReturnValueReversePointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<FormalReturnValueReversePointsToAlgorithm>
-    ::handleRelation<RETURNED_FROM_CALLEE>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<FormalReturnValueReversePointsToAlgorithm,
-      ReversePointsToAlgorithm>(Src);
+    ::handleRelation<RETURNED_FROM_CALLEE>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<FormalReturnValueReversePointsToAlgorithm,
+          ReversePointsToAlgorithm>(Dst, Src, Owner);
 }
 
 // LoadedValuesReversePointsToAlgorithm
 template<>
 struct ForAlgorithm<LoadedValuesReversePointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<LoadedValuesReversePointsToAlgorithm>
-    ::handleRelation<LOADED_FROM>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<LoadedValuesReversePointsToAlgorithm,
-      ReversePointsToAlgorithm>(Src);
+    ::handleRelation<LOADED_FROM>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<LoadedValuesReversePointsToAlgorithm,
+          ReversePointsToAlgorithm>(Dst, Src, Owner);
 }
 
 // PointsToAlgorithm
 template<>
 struct ForAlgorithm<PointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<PointsToAlgorithm>
-    ::handleRelation<ARGUMENT_FROM_CALLER>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<
+    ::handleRelation<ARGUMENT_FROM_CALLER>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<
       PointsToAlgorithm,
       TwoHopTraversal<ReversePointsToAlgorithm,
-                      ActualParametersPointsToAlgorithm>::Algorithm>(Dst);
+                      ActualParametersPointsToAlgorithm>::Algorithm>(
+          Src, Dst, Owner);
 }
 
 template<>
 inline void ForAlgorithm<PointsToAlgorithm>
-    ::handleRelation<DEPENDS_ON>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<PointsToAlgorithm,
-      PointsToAlgorithm>(Dst);
+    ::handleRelation<DEPENDS_ON>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<PointsToAlgorithm, PointsToAlgorithm>(Src, Dst, Owner);
 }
 
 template<>
 inline void ForAlgorithm<PointsToAlgorithm>
-    ::handleRelation<LOADED_FROM>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<
+    ::handleRelation<LOADED_FROM>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<
       PointsToAlgorithm,
       ThreeHopTraversal<PointsToAlgorithm,
                         ReversePointsToAlgorithm,
-                        StoredValuesPointsToAlgorithm>::Algorithm>(Dst);
+                        StoredValuesPointsToAlgorithm>::Algorithm>(
+          Src, Dst, Owner);
 }
 
 template<>
 inline void ForAlgorithm<PointsToAlgorithm>
-    ::handleRelation<RETURNED_FROM_CALLEE>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<
+    ::handleRelation<RETURNED_FROM_CALLEE>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<
       PointsToAlgorithm,
       TwoHopTraversal<PointsToAlgorithm,
-                      ActualReturnValuePointsToAlgorithm>::Algorithm>(Dst);
+                      ActualReturnValuePointsToAlgorithm>::Algorithm>(
+          Src, Dst, Owner);
 }
 
 // ReversePointsToAlgorithm
 template<>
 struct ForAlgorithm<ReversePointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<ReversePointsToAlgorithm>
-    ::handleRelation<ARGUMENT_TO_CALLEE>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<
+    ::handleRelation<ARGUMENT_TO_CALLEE>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<
       ReversePointsToAlgorithm,
       TwoHopTraversal<PointsToAlgorithm,
                       FormalParametersReversePointsToAlgorithm>::Algorithm>(
-          Dst);
+          Src, Dst, Owner);
 }
 
 template<>
 inline void ForAlgorithm<ReversePointsToAlgorithm>
-    ::handleRelation<DEPENDS_ON>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<ReversePointsToAlgorithm,
-      ReversePointsToAlgorithm>(Src);
+    ::handleRelation<DEPENDS_ON>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<ReversePointsToAlgorithm, ReversePointsToAlgorithm>(Dst, Src, Owner);
 }
 
 template<>
 inline void ForAlgorithm<ReversePointsToAlgorithm>
-    ::handleRelation<RETURNED_TO_CALLER>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<
+    ::handleRelation<RETURNED_TO_CALLER>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<
       ReversePointsToAlgorithm,
       TwoHopTraversal<
           ReversePointsToAlgorithm,
-          FormalReturnValueReversePointsToAlgorithm>::Algorithm>(Dst);
+          FormalReturnValueReversePointsToAlgorithm>::Algorithm>(
+          Src, Dst, Owner);
 }
 
 template<>
 inline void ForAlgorithm<ReversePointsToAlgorithm>
-    ::handleRelation<STORED_TO>(ValueInfo *Src, ValueInfo *Dst) {
-  Src->addInstructionAnalysisWork<
+    ::handleRelation<STORED_TO>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<
       ReversePointsToAlgorithm,
       ThreeHopTraversal<
           PointsToAlgorithm,
           ReversePointsToAlgorithm,
-          LoadedValuesReversePointsToAlgorithm>::Algorithm>(Dst);
+          LoadedValuesReversePointsToAlgorithm>::Algorithm>(Src, Dst, Owner);
 }
 
 // StoredValuesPointsToAlgorithm
 template<>
 struct ForAlgorithm<StoredValuesPointsToAlgorithm> {
   template<RelationType RT>
-  static void handleRelation(ValueInfo *Src, ValueInfo *Dst) {}
+  static void handleRelation(ValueInfo *Src, ValueInfo *Dst,
+                             const ValueInfo *Owner) {}
 };
 
 template<>
 inline void ForAlgorithm<StoredValuesPointsToAlgorithm>
-    ::handleRelation<STORED_TO>(ValueInfo *Src, ValueInfo *Dst) {
-  Dst->addInstructionAnalysisWork<StoredValuesPointsToAlgorithm,
-      PointsToAlgorithm>(Src);
+    ::handleRelation<STORED_TO>(ValueInfo *Src, ValueInfo *Dst,
+        const ValueInfo *Owner) {
+  addWork<StoredValuesPointsToAlgorithm, PointsToAlgorithm>(Dst, Src, Owner);
 }
 
 }
@@ -215,21 +256,21 @@ void RelationHandler::handleRelation(ValueInfo *Src, ValueInfo *Dst) {
   assert(Dst);
   // Dispatch to every relation-based algorithm.
   ForAlgorithm<ActualParametersPointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<ActualReturnValuePointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<FormalParametersReversePointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<FormalReturnValueReversePointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<LoadedValuesReversePointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<PointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<ReversePointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
   ForAlgorithm<StoredValuesPointsToAlgorithm>
-      ::handleRelation<RT>(Src, Dst);
+      ::handleRelation<RT>(Src, Dst, 0);
 }
 
 // Compile for each relation.
@@ -248,5 +289,117 @@ template void RelationHandler::handleRelation<RETURNED_TO_CALLER>(
 template void RelationHandler::handleRelation<STORED_TO>(
     ValueInfo *Src, ValueInfo *Dst);
 
+namespace {
+
+template<typename AlgorithmTy, RelationType RT>
+void handleRelationsFrom(ValueInfo *Owner, ArrayRef<uint32_t> Dsts,
+                         const RelationStore &Store) {
+  for (ArrayRef<uint32_t>::iterator i = Dsts.begin(), End = Dsts.end();
+       i != End; ++i) {
+    ValueInfo *Dst = Store.getValueInfo(*i);
+    if (CostAttribution *C = CostAttribution::getActive()) {
+      C->setCurrentRelation(RT, Owner, Dst);
+    }
+    if (Derivations *Derivs = Derivations::getActive()) {
+      Derivs->setCurrentRelation(RT, Owner, Dst);
+    }
+    ForAlgorithm<AlgorithmTy>::template handleRelation<RT>(Owner, Dst, Owner);
+  }
+}
+
+template<typename AlgorithmTy, RelationType RT>
+void handleRelationsTo(ValueInfo *Owner, ArrayRef<uint32_t> Srcs,
+                       const RelationStore &Store) {
+  for (ArrayRef<uint32_t>::iterator i = Srcs.begin(), End = Srcs.end();
+       i != End; ++i) {
+    // Relations of Owner to itself are handled as relations from it.
+    if (*i != Owner->getId()) {
+      ValueInfo *Src = Store.getValueInfo(*i);
+      if (CostAttribution *C = CostAttribution::getActive()) {
+        C->setCurrentRelation(RT, Src, Owner);
+      }
+      if (Derivations *Derivs = Derivations::getActive()) {
+        Derivs->setCurrentRelation(RT, Src, Owner);
+      }
+      ForAlgorithm<AlgorithmTy>::template handleRelation<RT>(Src, Owner, Owner);
+    }
+  }
+}
+
+template<typename AlgorithmTy, RelationType RT>
+void handleRelationsOfType(ValueInfo *Owner, const RelationStore &Store) {
+  uint32_t Id = Owner->getId();
+  handleRelationsFrom<AlgorithmTy, RT>(Owner, Store.getDestinations(RT, Id),
+                                       Store);
+  handleRelationsTo<AlgorithmTy, RT>(Owner, Store.getSources(RT, Id), Store);
+  if (Store.hasLateRelations()) {
+    SmallVector<uint32_t, 8> Ids;
+    Store.getLateDestinations(RT, Id, Ids);
+    handleRelationsFrom<AlgorithmTy, RT>(Owner, Ids, Store);
+    Ids.clear();
+    Store.getLateSources(RT, Id, Ids);
+    handleRelationsTo<AlgorithmTy, RT>(Owner, Ids, Store);
+  }
+}
+
+template<typename AlgorithmTy>
+void handleRelationsFor(ValueInfo *Owner, const RelationStore &Store) {
+  handleRelationsOfType<AlgorithmTy, ARGUMENT_FROM_CALLER>(Owner, Store);
+  handleRelationsOfType<AlgorithmTy, ARGUMENT_TO_CALLEE>(Owner, Store);
+  handleRelationsOfType<AlgorithmTy, DEPENDS_ON>(Owner, Store);
+  handleRelationsOfType<AlgorithmTy, LOADED_FROM>(Owner, Store);
+  handleRelationsOfType<AlgorithmTy, RETURNED_FROM_CALLEE>(Owner, Store);
+  handleRelationsOfType<AlgorithmTy, RETURNED_TO_CALLER>(Owner, Store);
+  handleRelationsOfType<AlgorithmTy, STORED_TO>(Owner, Store);
+}
+
+struct RelationBasedAlgorithm {
+  const AlgorithmId *Id;
+  void (*HandleRelations)(ValueInfo *, const RelationStore &);
+};
+
+const RelationBasedAlgorithm RelationBasedAlgorithms[] = {
+  { &ActualParametersPointsToAlgorithm::ID,
+    &handleRelationsFor<ActualParametersPointsToAlgorithm> },
+  { &ActualReturnValuePointsToAlgorithm::ID,
+    &handleRelationsFor<ActualReturnValuePointsToAlgorithm> },
+  { &FormalParametersReversePointsToAlgorithm::ID,
+    &handleRelationsFor<FormalParametersReversePointsToAlgorithm> },
+  { &FormalReturnValueReversePointsToAlgorithm::ID,
+    &handleRelationsFor<FormalReturnValueReversePointsToAlgorithm> },
+  { &LoadedValuesReversePointsToAlgorithm::ID,
+    &handleRelationsFor<LoadedValuesReversePointsToAlgorithm> },
+  { &PointsToAlgorithm::ID,
+    &handleRelationsFor<PointsToAlgorithm> },
+  { &ReversePointsToAlgorithm::ID,
+    &handleRelationsFor<ReversePointsToAlgorithm> },
+  { &StoredValuesPointsToAlgorithm::ID,
+    &handleRelationsFor<StoredValuesPointsToAlgorithm> }
+};
+
+const RelationBasedAlgorithm *findRelationBasedAlgorithm(
+    const AlgorithmId *Id) {
+  for (size_t i = 0; i != array_lengthof(RelationBasedAlgorithms); ++i) {
+    if (RelationBasedAlgorithms[i].Id == Id) {
+      return &RelationBasedAlgorithms[i];
+    }
+  }
+  return 0;
+}
+
+}
+
+bool RelationHandler::isRelationBased(const AlgorithmId *Id) {
+  return findRelationBasedAlgorithm(Id);
+}
+
+void RelationHandler::handleRelations(const AlgorithmId *Id, ValueInfo *Owner,
+                                      const RelationStore &Store) {
+  assert(Owner);
+  const RelationBasedAlgorithm *RBA = findRelationBasedAlgorithm(Id);
+  assert(RBA && "Not a relation-based algorithm");
+  (*RBA->HandleRelations)(Owner, Store);
+}
+
 }
 }
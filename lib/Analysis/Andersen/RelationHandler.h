@@ -20,6 +20,8 @@
 namespace llvm {
 namespace andersen_internal {
 
+class AlgorithmId;
+class RelationStore;
 class ValueInfo;
 
 struct RelationHandler {
@@ -27,6 +29,14 @@ struct RelationHandler {
   // Dst.
   template<RelationType RT>
   static void handleRelation(ValueInfo *Src, ValueInfo *Dst);
+
+  // Whether the results of the algorithm Id are built from relations.
+  static bool isRelationBased(const AlgorithmId *Id);
+
+  // Creates the graph traversal steps of the relation-based algorithm Id for
+  // Owner only, from the relations in Store that Owner takes part in.
+  static void handleRelations(const AlgorithmId *Id, ValueInfo *Owner,
+                              const RelationStore &Store);
 };
 
 }
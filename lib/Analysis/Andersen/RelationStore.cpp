@@ -0,0 +1,199 @@
+//===- RelationStore.cpp - compact store of the relations -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type that records the relations produced by instruction
+// analysis as compact edges between ValueInfo ids, so that the analysis results
+// of the relation-based algorithms are only built when first needed.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "andersen"
+#include "RelationStore.h"
+
+#include "AnalysisResult.h"
+#include "Data.h"
+#include "PointsToAlgorithm.h"
+#include "RelationHandler.h"
+#include "ValueInfo.h"
+#include "llvm/ADT/Statistic.h"
+
+namespace llvm {
+namespace andersen_internal {
+
+STATISTIC(NumResultsBuilt, "Number of analysis results built from relations");
+
+DeferredRelations::~DeferredRelations() {}
+
+void RelationStore::Index::build(const EdgeVector &Edges, bool BySource,
+                                 uint32_t NumValueInfos) {
+  // Counting sort, which keeps the edges of each VI in order.
+  Offsets.assign(NumValueInfos + 1, 0);
+  for (EdgeVector::const_iterator i = Edges.begin(), End = Edges.end();
+       i != End; ++i) {
+    ++Offsets[(BySource ? i->first : i->second) + 1];
+  }
+  for (uint32_t i = 0; i != NumValueInfos; ++i) {
+    Offsets[i + 1] += Offsets[i];
+  }
+  Others.resize(Edges.size());
+  std::vector<uint32_t> Next(Offsets.begin(), Offsets.end() - 1);
+  for (EdgeVector::const_iterator i = Edges.begin(), End = Edges.end();
+       i != End; ++i) {
+    if (BySource) {
+      Others[Next[i->first]++] = i->second;
+    } else {
+      Others[Next[i->second]++] = i->first;
+    }
+  }
+}
+
+ArrayRef<uint32_t> RelationStore::Index::lookup(uint32_t Id) const {
+  // VIs created after the index was built have no entry.
+  if (Id + 1 >= Offsets.size()) {
+    return ArrayRef<uint32_t>();
+  }
+  const uint32_t *Begin = Others.empty() ? 0 : &Others[0];
+  return ArrayRef<uint32_t>(Begin + Offsets[Id], Begin + Offsets[Id + 1]);
+}
+
+void RelationStore::lookupLate(const LateIndex &Late, uint32_t Id,
+                               SmallVectorImpl<uint32_t> &Ids) {
+  LateIndex::const_iterator i = Late.find(Id);
+  if (i != Late.end()) {
+    Ids.append(i->second.begin(), i->second.end());
+  }
+}
+
+RelationStore::RelationStore()
+  : HasLateRelations(false), Deferred(0), NumRelations(0), Building(false),
+    ShareTransforms(false) {}
+
+RelationStore::~RelationStore() {
+  delete Deferred;
+}
+
+void RelationStore::addRegion(const ValueInfo *VI) {
+  if (VI->getId() >= Regions.size()) {
+    Regions.resize(VI->getId() + 1);
+  }
+  Regions.set(VI->getId());
+}
+
+void RelationStore::addRelation(RelationType RT, const ValueInfo *Src,
+                                const ValueInfo *Dst) {
+  ++NumRelations;
+  if (ValueInfos.empty()) {
+    Edges[RT].push_back(std::make_pair(Src->getId(), Dst->getId()));
+    return;
+  }
+  LateBySource[RT][Src->getId()].push_back(Dst->getId());
+  LateByDestination[RT][Dst->getId()].push_back(Src->getId());
+  HasLateRelations = true;
+}
+
+void RelationStore::finish(const std::vector<ValueInfo *> &ValueInfosById) {
+  uint32_t N = ValueInfosById.size();
+  for (unsigned RT = 0; RT != NumRelationTypes; ++RT) {
+    BySource[RT].build(Edges[RT], true, N);
+    ByDestination[RT].build(Edges[RT], false, N);
+    EdgeVector().swap(Edges[RT]);
+  }
+  Regions.resize(N);
+  UnificationClasses.assign(N, AnalysisResult::NoUnificationClass);
+  ValueInfos = ValueInfosById;
+}
+
+void RelationStore::addValueInfo(ValueInfo *VI) {
+  assert(!ValueInfos.empty() && "Relations not finished yet");
+  assert(VI->getId() == ValueInfos.size());
+  ValueInfos.push_back(VI);
+  Regions.resize(ValueInfos.size());
+  UnificationClasses.push_back(AnalysisResult::NoUnificationClass);
+}
+
+void RelationStore::setDeferredRelations(DeferredRelations *DR) {
+  assert(!Deferred);
+  Deferred = DR;
+}
+
+void RelationStore::addDeferredRelations(const ValueInfo *VI,
+                                         const AlgorithmId *Id) {
+  if (Deferred) {
+    Deferred->addRelationsFor(VI, Id);
+  }
+}
+
+void RelationStore::addDeferredRelationsUsing(const Value *V) {
+  if (Deferred) {
+    Deferred->addRelationsUsing(V);
+  }
+}
+
+bool RelationStore::hasRelations(const ValueInfo *VI) const {
+  uint32_t Id = VI->getId();
+  if (Regions.test(Id)) {
+    return true;
+  }
+  for (unsigned RT = 0; RT != NumRelationTypes; ++RT) {
+    if (!BySource[RT].lookup(Id).empty() ||
+        !ByDestination[RT].lookup(Id).empty()) {
+      return true;
+    }
+    if (HasLateRelations && (LateBySource[RT].count(Id) ||
+                             LateByDestination[RT].count(Id))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RelationStore::setUnificationClass(const ValueInfo *VI, uint32_t Class) {
+  assert(VI->getId() < UnificationClasses.size());
+  UnificationClasses[VI->getId()] = Class;
+}
+
+void RelationStore::buildAlgorithmResult(ValueInfo *VI, const AlgorithmId *Id,
+                                         AnalysisResult *AR) {
+  // Nothing can depend on relations added after AR is built, so add them now.
+  addDeferredRelations(VI, Id);
+  if (Id == &PointsToAlgorithm::ID) {
+    if (Regions.test(VI->getId())) {
+      AR->addValueInfo(VI);
+    }
+    AR->setUnificationClass(UnificationClasses[VI->getId()]);
+  }
+  if (!RelationHandler::isRelationBased(Id)) {
+    // A transform of the result of another algorithm, built from it rather
+    // than from relations.
+    if (ShareTransforms) {
+      NewTransforms.push_back(AR);
+    }
+  } else {
+    ++NumResultsBuilt;
+    Queue.push_back(std::make_pair(VI, Id));
+  }
+  if (Building) {
+    return;
+  }
+  Building = true;
+  // Index every time, since handling relations grows the queue.
+  for (size_t i = 0; i != Queue.size(); ++i) {
+    RelationHandler::handleRelations(Queue[i].second, Queue[i].first, *this);
+  }
+  Queue.clear();
+  // Every result built meanwhile is complete now.
+  for (size_t i = 0; i != NewTransforms.size(); ++i) {
+    VI->getOwner().shareTransformResult(NewTransforms[i]);
+  }
+  NewTransforms.clear();
+  Building = false;
+}
+
+}
+}
@@ -0,0 +1,195 @@
+//===- RelationStore.h - compact store of the relations -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type that records the relations produced by instruction
+// analysis as compact edges between ValueInfo ids, so that the analysis results
+// of the relation-based algorithms are only built when first needed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RELATIONSTORE_H
+#define RELATIONSTORE_H
+
+#include "RelationType.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+class Value;
+
+}
+
+namespace llvm {
+namespace andersen_internal {
+
+class AlgorithmId;
+class AnalysisResult;
+class ValueInfo;
+
+const unsigned NumRelationTypes = STORED_TO + 1;
+
+// Relations that instruction analysis left out, to be added to the store only
+// when the first result depending on them is built.
+class DeferredRelations {
+public:
+  virtual ~DeferredRelations();
+
+  // Add all deferred relations that the result of the algorithm Id for VI may
+  // depend on.
+  virtual void addRelationsFor(const ValueInfo *VI, const AlgorithmId *Id) = 0;
+
+  // Add the deferred relations of the constants that contain V, which gives V
+  // its VI if only those hold it.
+  virtual void addRelationsUsing(const Value *V) = 0;
+};
+
+class RelationStore {
+  typedef std::vector<std::pair<uint32_t, uint32_t> > EdgeVector;
+  typedef std::vector<std::pair<ValueInfo *, const AlgorithmId *> >
+      BuildQueue;
+  typedef DenseMap<uint32_t, std::vector<uint32_t> > LateIndex;
+
+  // The edges of one relation type by one of their ends: the other ends of the
+  // edges at the VI with id i are Others[Offsets[i]] to Others[Offsets[i + 1]],
+  // in the order the relations were added.
+  struct Index {
+    std::vector<uint32_t> Offsets;
+    std::vector<uint32_t> Others;
+
+    void build(const EdgeVector &Edges, bool BySource,
+               uint32_t NumValueInfos);
+    ArrayRef<uint32_t> lookup(uint32_t Id) const;
+  };
+
+  // (source id, destination id) pairs of each relation type. Emptied by
+  // finish().
+  EdgeVector Edges[NumRelationTypes];
+  Index BySource[NumRelationTypes];
+  Index ByDestination[NumRelationTypes];
+  // Relations added after finish(), by each of their ends.
+  LateIndex LateBySource[NumRelationTypes];
+  LateIndex LateByDestination[NumRelationTypes];
+  bool HasLateRelations;
+  // Owned. Null if nothing was deferred.
+  DeferredRelations *Deferred;
+  // VIs that are regions, by id.
+  BitVector Regions;
+  std::vector<ValueInfo *> ValueInfos;
+  std::vector<uint32_t> UnificationClasses;
+  size_t NumRelations;
+  // Results whose relations are yet to be added. Building a result creates the
+  // results of its inputs, which are queued here rather than built
+  // recursively.
+  BuildQueue Queue;
+  bool Building;
+  // Whether to share the results of equal transforms as they are built.
+  bool ShareTransforms;
+  // Transform results built since the queue was last empty, whose inputs may
+  // still lack work until it is.
+  std::vector<AnalysisResult *> NewTransforms;
+
+  static void lookupLate(const LateIndex &Late, uint32_t Id,
+                         SmallVectorImpl<uint32_t> &Ids);
+
+public:
+  RelationStore();
+  ~RelationStore();
+
+  void addRegion(const ValueInfo *VI);
+  void addRelation(RelationType RT, const ValueInfo *Src,
+                   const ValueInfo *Dst);
+
+  // Index the relations by both ends, given all the VIs by id. From now on,
+  // the VIs build their results from the relations. Relations added afterwards
+  // must not concern any result built so far.
+  void finish(const std::vector<ValueInfo *> &ValueInfosById);
+
+  // Make a VI created after finish() build its results from the relations.
+  void addValueInfo(ValueInfo *VI);
+
+  // Whether finish() was called, after which results are built from the
+  // relations.
+  bool isFinished() const { return !ValueInfos.empty(); }
+
+  // Takes ownership of DR, which is asked for its relations before each result
+  // is built.
+  void setDeferredRelations(DeferredRelations *DR);
+
+  // Make each result that is only a transform share the result of an earlier
+  // one of an equal input, once its input is complete.
+  void setShareTransforms(bool Share) { ShareTransforms = Share; }
+
+  // Add the deferred relations that the result of the algorithm Id for VI may
+  // depend on, if any.
+  void addDeferredRelations(const ValueInfo *VI, const AlgorithmId *Id);
+
+  // Add the deferred relations of the constants that contain V, if any.
+  void addDeferredRelationsUsing(const Value *V);
+
+  size_t getNumRelations() const { return NumRelations; }
+
+  ValueInfo *getValueInfo(uint32_t Id) const {
+    assert(Id < ValueInfos.size() && ValueInfos[Id]);
+    return ValueInfos[Id];
+  }
+
+  // The ids of the destinations of the relations of type RT from the VI with
+  // id SrcId.
+  ArrayRef<uint32_t> getDestinations(RelationType RT, uint32_t SrcId) const {
+    return BySource[RT].lookup(SrcId);
+  }
+
+  // The ids of the sources of the relations of type RT to the VI with id DstId.
+  ArrayRef<uint32_t> getSources(RelationType RT, uint32_t DstId) const {
+    return ByDestination[RT].lookup(DstId);
+  }
+
+  bool isRegion(uint32_t Id) const {
+    return Id < Regions.size() && Regions.test(Id);
+  }
+
+  bool hasLateRelations() const { return HasLateRelations; }
+
+  // Like getDestinations and getSources, for the relations added after
+  // finish(). These are copied, since building results may add more.
+  void getLateDestinations(RelationType RT, uint32_t SrcId,
+                           SmallVectorImpl<uint32_t> &Ids) const {
+    lookupLate(LateBySource[RT], SrcId, Ids);
+  }
+
+  void getLateSources(RelationType RT, uint32_t DstId,
+                      SmallVectorImpl<uint32_t> &Ids) const {
+    lookupLate(LateByDestination[RT], DstId, Ids);
+  }
+
+  // Whether VI is a region or takes part in any relation. Only such VIs can
+  // have non-empty results.
+  bool hasRelations(const ValueInfo *VI) const;
+
+  // Set the unification class to give VI's points-to set once it is built.
+  void setUnificationClass(const ValueInfo *VI, uint32_t Class);
+
+  // Add the relations of VI to AR, a newly created result of the algorithm Id
+  // for VI. ARs of other VIs created meanwhile are complete once this returns.
+  void buildAlgorithmResult(ValueInfo *VI, const AlgorithmId *Id,
+                            AnalysisResult *AR);
+};
+
+}
+}
+
+#endif
@@ -7,41 +7,39 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file defines a template type for transforms that compute the list
-// comprehension of a ValueInfo-to-AnalysisResult function run on the elements
-// of an input AnalysisResult.
+// This file defines a template type providing the TransformAlgorithm for
+// transforms that compute the list comprehension of a ValueInfo-to-
+// AnalysisResult function run on the elements of an input AnalysisResult.
 //
 //===----------------------------------------------------------------------===//
 
 #ifndef TRANSFORMWORK_H
 #define TRANSFORMWORK_H
 
+#include "AnalysisResultWork.h"
 #include "Phase.h"
-#include "TransformWorkBase.h"
 #include "ValueInfo.h"
 
-#include <string>
-
 namespace llvm {
 namespace andersen_internal {
 
 class AnalysisResult;
 
 template<typename AlgorithmTy>
-class TransformWork : public TransformWorkBase {
-public:
-  explicit TransformWork(AnalysisResult *AR) : TransformWorkBase(AR) {}
-
-  virtual const AlgorithmId *getAlgorithmId() const {
-    return &AlgorithmTy::ID;
-  }
+struct TransformWork {
+  static const TransformAlgorithm Algorithm;
 
-protected:
-  virtual AnalysisResult *analyzeValueInfo(ValueInfo *VI) {
+  static AnalysisResult *analyzeValueInfo(ValueInfo *VI) {
     return VI->getAlgorithmResult<AlgorithmTy, ENUMERATION_PHASE>();
   }
 };
 
+template<typename AlgorithmTy>
+const TransformAlgorithm TransformWork<AlgorithmTy>::Algorithm = {
+  &AlgorithmTy::ID,
+  &TransformWork<AlgorithmTy>::analyzeValueInfo
+};
+
 }
 }
 
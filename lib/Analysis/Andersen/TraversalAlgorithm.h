@@ -35,8 +35,9 @@ private:
 
     static AnalysisResult *run(ValueInfo *VI) {
       AnalysisResult *AR = new AnalysisResult();
-      AR->appendUniqueTransform(new TransformWork<SecondHopAlgorithm>(
-          VI->getAlgorithmResult<FirstHopAlgorithm, RunPhase>()));
+      AR->appendUniqueTransform(VI->getOwner(),
+          &TransformWork<SecondHopAlgorithm>::Algorithm,
+          VI->getAlgorithmResult<FirstHopAlgorithm, RunPhase>());
       return AR;
     }
   };
@@ -55,7 +56,11 @@ const TraversalAlgorithmId TraversalBase::TraversalAlgorithm<
     FirstHopAlgorithm,
     SecondHopAlgorithm,
     RunPhase>::ID(&FirstHopAlgorithm::ID,
-                  &SecondHopAlgorithm::ID);
+                  &SecondHopAlgorithm::ID,
+                  &TraversalBase::TraversalAlgorithm<
+                      FirstHopAlgorithm,
+                      SecondHopAlgorithm,
+                      RunPhase>::run);
 
 template<typename FirstHopAlgorithm, typename SecondHopAlgorithm>
 struct TwoHopTraversal : private TraversalBase {
@@ -22,8 +22,8 @@ namespace llvm {
 namespace andersen_internal {
 
 TraversalAlgorithmId::TraversalAlgorithmId(
-    const AlgorithmId *SrcId, const AlgorithmId *DstId)
-  : SrcId(SrcId), DstId(DstId) {}
+    const AlgorithmId *SrcId, const AlgorithmId *DstId, RecomputeFn Recompute)
+  : SrcId(SrcId), DstId(DstId), Recompute(Recompute) {}
 
 TraversalAlgorithmId::~TraversalAlgorithmId() {}
 
@@ -34,5 +34,11 @@ void TraversalAlgorithmId::printAlgorithmName(raw_ostream &OS) const {
   SrcId->printAlgorithmName(OS);
 }
 
+AlgorithmId::RecomputeFn TraversalAlgorithmId::getRecomputeFn() const {
+  // The results only cache a transform of another result, so they can always
+  // be computed again.
+  return Recompute;
+}
+
 }
 }
@@ -24,14 +24,17 @@ namespace andersen_internal {
 
 class TraversalAlgorithmId : public AlgorithmId {
 public:
-  TraversalAlgorithmId(const AlgorithmId *SrcId, const AlgorithmId *DstId);
+  TraversalAlgorithmId(const AlgorithmId *SrcId, const AlgorithmId *DstId,
+                       RecomputeFn Recompute);
   ~TraversalAlgorithmId();
 
   virtual void printAlgorithmName(raw_ostream &OS) const;
+  virtual RecomputeFn getRecomputeFn() const;
 
 private:
   const AlgorithmId *const SrcId;
   const AlgorithmId *const DstId;
+  const RecomputeFn Recompute;
 };
 
 }
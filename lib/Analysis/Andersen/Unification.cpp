@@ -0,0 +1,173 @@
+//===- Unification.cpp - unification-based pre-analysis -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a type for a Steensgaard-style, unification-based
+// approximation of the points-to relation, built from the same relations as
+// the Andersen analysis in near-linear time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Unification.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#include <cassert>
+#include <utility>
+
+namespace llvm {
+namespace andersen_internal {
+
+namespace {
+
+const uint32_t NoNode = ~uint32_t(0);
+
+}
+
+uint32_t Unification::makeNode() {
+  uint32_t N = Parent.size();
+  Parent.push_back(N);
+  Rank.push_back(0);
+  Pointee.push_back(NoNode);
+  Contents.push_back(NoNode);
+  return N;
+}
+
+uint32_t Unification::find(uint32_t N) {
+  uint32_t Root = N;
+  while (Parent[Root] != Root) {
+    Root = Parent[Root];
+  }
+  while (Parent[N] != Root) {
+    uint32_t Next = Parent[N];
+    Parent[N] = Root;
+    N = Next;
+  }
+  return Root;
+}
+
+uint32_t Unification::getNode(const ValueInfo *VI) {
+  std::pair<DenseMap<const ValueInfo *, uint32_t>::iterator, bool> P =
+      Nodes.insert(std::make_pair(VI, NoNode));
+  if (P.second) {
+    P.first->second = makeNode();
+  }
+  return P.first->second;
+}
+
+uint32_t Unification::getPointee(uint32_t N) {
+  N = find(N);
+  if (Pointee[N] == NoNode) {
+    uint32_t P = makeNode();
+    Pointee[N] = P;
+  }
+  return Pointee[N];
+}
+
+uint32_t Unification::getContents(uint32_t N) {
+  N = find(N);
+  if (Contents[N] == NoNode) {
+    uint32_t C = makeNode();
+    Contents[N] = C;
+  }
+  return Contents[N];
+}
+
+void Unification::join(uint32_t A, uint32_t B) {
+  // Joining two nodes requires joining their pointees and contents, which is
+  // done with a worklist rather than recursion because the chains can be long.
+  SmallVector<std::pair<uint32_t, uint32_t>, 8> Pending;
+  Pending.push_back(std::make_pair(A, B));
+  while (!Pending.empty()) {
+    A = find(Pending.back().first);
+    B = find(Pending.back().second);
+    Pending.pop_back();
+    if (A == B) continue;
+    if (Rank[A] < Rank[B]) {
+      std::swap(A, B);
+    }
+    Parent[B] = A;
+    if (Rank[A] == Rank[B]) {
+      ++Rank[A];
+    }
+    if (Pointee[B] != NoNode) {
+      if (Pointee[A] == NoNode) {
+        Pointee[A] = Pointee[B];
+      } else {
+        Pending.push_back(std::make_pair(Pointee[A], Pointee[B]));
+      }
+    }
+    if (Contents[B] != NoNode) {
+      if (Contents[A] == NoNode) {
+        Contents[A] = Contents[B];
+      } else {
+        Pending.push_back(std::make_pair(Contents[A], Contents[B]));
+      }
+    }
+  }
+}
+
+void Unification::addRegion(const ValueInfo *VI) {
+  uint32_t N = getNode(VI);
+  join(getPointee(N), N);
+}
+
+void Unification::addRelation(RelationType RT, const ValueInfo *Src,
+                              const ValueInfo *Dst) {
+  uint32_t SrcPointee = getPointee(getNode(Src));
+  uint32_t DstPointee = getPointee(getNode(Dst));
+  switch (RT) {
+  case DEPENDS_ON:
+    join(SrcPointee, DstPointee);
+    break;
+
+  // Calls are modelled as accesses to the contents of the called regions,
+  // which hold the arguments and return values of the functions.
+  case ARGUMENT_FROM_CALLER:
+  case LOADED_FROM:
+  case RETURNED_FROM_CALLEE:
+    join(SrcPointee, getContents(DstPointee));
+    break;
+
+  case ARGUMENT_TO_CALLEE:
+  case RETURNED_TO_CALLER:
+  case STORED_TO:
+    join(getContents(DstPointee), SrcPointee);
+    break;
+
+  default:
+    llvm_unreachable("Not a recognized RelationType");
+    break;
+  }
+}
+
+void Unification::addUnknownStores(
+    const std::vector<const ValueInfo *> &Values,
+    const std::vector<const ValueInfo *> &Regions) {
+  // Like a STORED_TO relation from every value to every region, through one
+  // node so that this takes linear time.
+  uint32_t Stored = makeNode();
+  for (std::vector<const ValueInfo *>::const_iterator i = Values.begin(),
+                                                      End = Values.end();
+       i != End; ++i) {
+    join(Stored, getPointee(getNode(*i)));
+  }
+  for (std::vector<const ValueInfo *>::const_iterator i = Regions.begin(),
+                                                      End = Regions.end();
+       i != End; ++i) {
+    join(getContents(getPointee(getNode(*i))), Stored);
+  }
+}
+
+uint32_t Unification::getPointsToClass(const ValueInfo *VI) {
+  return find(getPointee(getNode(VI)));
+}
+
+}
+}
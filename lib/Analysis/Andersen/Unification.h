@@ -0,0 +1,65 @@
+//===- Unification.h - unification-based pre-analysis ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a type for a Steensgaard-style, unification-based
+// approximation of the points-to relation, built from the same relations as
+// the Andersen analysis in near-linear time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef UNIFICATION_H
+#define UNIFICATION_H
+
+#include "RelationType.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <vector>
+
+namespace llvm {
+namespace andersen_internal {
+
+class ValueInfo;
+
+class Unification {
+  // Union-find forest of nodes. Every ValueInfo has a node. A node may have a
+  // pointee node, for the regions that its values point to, and a contents
+  // node, for the regions pointed to by the values stored in its regions.
+  // Relations join nodes, and joining two nodes joins their pointees and
+  // contents as well.
+  std::vector<uint32_t> Parent;
+  std::vector<uint32_t> Rank;
+  std::vector<uint32_t> Pointee;
+  std::vector<uint32_t> Contents;
+  DenseMap<const ValueInfo *, uint32_t> Nodes;
+
+  uint32_t makeNode();
+  uint32_t find(uint32_t N);
+  uint32_t getNode(const ValueInfo *VI);
+  uint32_t getPointee(uint32_t N);
+  uint32_t getContents(uint32_t N);
+  void join(uint32_t A, uint32_t B);
+
+public:
+  // VI is a region, so it is in its own points-to set.
+  void addRegion(const ValueInfo *VI);
+  void addRelation(RelationType RT, const ValueInfo *Src, const ValueInfo *Dst);
+  // Any of Values may be stored to any of Regions by relations not added.
+  void addUnknownStores(const std::vector<const ValueInfo *> &Values,
+                        const std::vector<const ValueInfo *> &Regions);
+
+  // The class of the regions that VI may point to. If two ValueInfos have
+  // different classes, their points-to sets have no element in common.
+  uint32_t getPointsToClass(const ValueInfo *VI);
+};
+
+}
+}
+
+#endif
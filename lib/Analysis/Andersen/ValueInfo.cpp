@@ -15,39 +15,31 @@
 
 #include "AlgorithmId.h"
 #include "AnalysisResult.h"
+#include "CostAttribution.h"
+#include "Data.h"
 #include "DebugInfo.h"
+#include "Derivations.h"
+#include "RelationStore.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/Support/raw_os_ostream.h"
-
-#include <sstream>
 
 namespace llvm {
 namespace andersen_internal {
 
-ValueInfo::ValueInfo(const Value *V) : V(V) {}
+ValueInfo::ValueInfo(Data *Owner, const Value *V, uint32_t Id)
+  : V(V), Id(Id), Owner(Owner) {}
 
 ValueInfo::~ValueInfo() {
   DeleteContainerSeconds(Results);
 }
 
-GraphEdgeDeque ValueInfo::getOutgoingEdges() const {
-  GraphEdgeDeque Result;
+void ValueInfo::getOutgoingEdges(const Data &D, GraphEdgeVector &Edges) const {
   for (ResultsMapTy::const_iterator i = Results.begin(), End = Results.end();
        i != End; ++i) {
-    const AlgorithmId *Id = i->first;
-    AnalysisResult *AR = i->second;
-    std::ostringstream OSS;
-    OSS << "PointsTo(";
-    {
-      raw_os_ostream OS(OSS);
-      Id->printAlgorithmName(OS);
-    }
-    OSS << ')';
-    Result.push_back(GraphEdge(AR, OSS.str()));
+    Edges.push_back(GraphEdge(i->second, GraphEdge::RESULT, i->first));
   }
-  return Result;
 }
 
 void ValueInfo::printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const {
@@ -72,12 +64,53 @@ void ValueInfo::writeEquations(const DebugInfo &DI, raw_ostream &OS) const {
   }
 }
 
+void ValueInfo::collectPendingInputs(DenseSet<AnalysisResult *> &Inputs) const {
+  for (ResultsMapTy::const_iterator i = Results.begin(), End = Results.end();
+       i != End; ++i) {
+    i->second->collectInputs(Inputs);
+  }
+}
+
+size_t ValueInfo::evictIntermediateResults(
+    const DenseSet<AnalysisResult *> &Inputs) {
+  // Recomputing can look up other results of this VI, so find the victims
+  // before changing anything.
+  typedef SmallVector<std::pair<AnalysisResult *, AlgorithmId::RecomputeFn>, 4>
+      VictimVector;
+  VictimVector Victims;
+  for (ResultsMapTy::const_iterator i = Results.begin(), End = Results.end();
+       i != End; ++i) {
+    AlgorithmId::RecomputeFn Recompute = i->first->getRecomputeFn();
+    AnalysisResult *AR = i->second;
+    if (!Recompute || !AR->isDone() || AR->getSetContentsSoFar().empty() ||
+        Inputs.count(AR)) {
+      continue;
+    }
+    Victims.push_back(std::make_pair(AR, Recompute));
+  }
+  size_t Released = 0;
+  for (VictimVector::const_iterator i = Victims.begin(), End = Victims.end();
+       i != End; ++i) {
+    Released += i->first->getSetContentsSoFar().size();
+    i->first->reset(*Owner, (*i->second)(this));
+  }
+  return Released;
+}
+
 AnalysisResult *ValueInfo::getOrCreateAlgorithmResult(const AlgorithmId *Id,
     AlgorithmFn Fn) {
-  AnalysisResult *&AR = Results[Id];
-  if (!AR) {
-    AR = (*Fn)(this);
-    assert(AR);
+  AnalysisResult *&Slot = Results[Id];
+  if (Slot) {
+    return Slot;
+  }
+  // Computing the result may add other results of this VI, which invalidates
+  // Slot.
+  AnalysisResult *AR = (*Fn)(this);
+  assert(AR);
+  Results[Id] = AR;
+  Owner->addAnalysisResult(this, Id, AR);
+  if (RelationStore *Relations = Owner->getFinishedRelations()) {
+    Relations->buildAlgorithmResult(this, Id, AR);
   }
   return AR;
 }
@@ -91,11 +124,43 @@ AnalysisResult *ValueInfo::getAlgorithmResultOrNull(const AlgorithmId *Id)
   return i->second;
 }
 
+AnalysisResult *ValueInfo::getAlgorithmResultIfAny(const AlgorithmId *Id,
+    AlgorithmFn Fn) {
+  if (AnalysisResult *AR = getAlgorithmResultOrNull(Id)) {
+    return AR;
+  }
+  RelationStore *Relations = Owner->getFinishedRelations();
+  if (!Relations) {
+    return 0;
+  }
+  Relations->addDeferredRelations(this, Id);
+  if (!Relations->hasRelations(this)) {
+    return 0;
+  }
+  return getOrCreateAlgorithmResult(Id, Fn);
+}
+
 void ValueInfo::addInstructionAnalysisWorkInternal(const AlgorithmId *Id1,
     AlgorithmFn Fn1, ValueInfo *that, const AlgorithmId *Id2,
     AlgorithmFn Fn2) {
-  getOrCreateAlgorithmResult(Id1, Fn1)->appendSubset(
-      that->getOrCreateAlgorithmResult(Id2, Fn2));
+  CostAttribution *C = CostAttribution::getActive();
+  Derivations *Derivs = Derivations::getActive();
+  // Creating the results may analyze an initializer or build them from other
+  // relations, which moves the current relation on.
+  unsigned Origin = C ? C->getCurrentOrigin() : 0;
+  Derivations::Relation Rel;
+  if (Derivs) {
+    Rel = Derivs->getCurrentRelation();
+  }
+  AnalysisResult *AR = getOrCreateAlgorithmResult(Id1, Fn1);
+  AnalysisResult *Subset = that->getOrCreateAlgorithmResult(Id2, Fn2);
+  if (C) {
+    C->addSubset(AR, Subset, Origin);
+  }
+  if (Derivs) {
+    Derivs->addRelation(AR, Subset, Rel);
+  }
+  AR->appendSubset(Subset);
 }
 
 }
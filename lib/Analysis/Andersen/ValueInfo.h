@@ -17,7 +17,9 @@
 #include "GraphNode.h"
 #include "Phase.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/DataTypes.h"
 
 #include <cassert>
 
@@ -33,11 +35,13 @@ namespace andersen_internal {
 
 class AlgorithmId;
 class AnalysisResult;
+class Data;
 class DebugInfoFiller;
 
 class ValueInfo : private RefCountedBase<ValueInfo>, public GraphNode {
   friend struct IntrusiveRefCntPtrInfo<ValueInfo>;
   friend class RefCountedBase<ValueInfo>;
+  friend class Data;
   typedef AnalysisResult *(*AlgorithmFn)(ValueInfo *);
   typedef DenseMap<const AlgorithmId *, AnalysisResult *> ResultsMapTy;
   ResultsMapTy Results;
@@ -45,23 +49,43 @@ class ValueInfo : private RefCountedBase<ValueInfo>, public GraphNode {
   // owned by Data. (If this analysis applies to multiple Values, this is the
   // first one that was analyzed.)
   const Value *V;
+  // Dense id, unique within the owning Data. Data may renumber these before
+  // enumeration starts.
+  uint32_t Id;
+  // The Data this belongs to, which also holds the relations from which
+  // results are built when first needed, if any.
+  Data *Owner;
 
 public:
   typedef IntrusiveRefCntPtr<ValueInfo> Ref;
 
-  ValueInfo(const Value *V);
+  ValueInfo(Data *Owner, const Value *V, uint32_t Id);
 
   const Value *getValue() const {
     return V;
   }
 
-  virtual GraphEdgeDeque getOutgoingEdges() const;
+  uint32_t getId() const {
+    return Id;
+  }
+
+  Data &getOwner() const {
+    return *Owner;
+  }
+
+  virtual void getOutgoingEdges(const Data &D, GraphEdgeVector &Edges) const;
   virtual void printNodeLabel(const DebugInfo &DI, raw_ostream &OS) const;
   virtual bool isNodeHidden() const;
 
   void fillDebugInfo(DebugInfoFiller *DIF) const;
   void writeEquations(const DebugInfo &DI, raw_ostream &OS) const;
 
+  // Add the inputs of all pending work of this VI's results to Inputs.
+  void collectPendingInputs(DenseSet<AnalysisResult *> &Inputs) const;
+  // Reset the done results of recomputable algorithms that are not in Inputs.
+  // Returns the number of set elements released.
+  size_t evictIntermediateResults(const DenseSet<AnalysisResult *> &Inputs);
+
   template<typename AlgorithmTy, Phase CurrentPhase>
   AnalysisResult *getAlgorithmResult() {
     return GetAlgorithmResultHelper<
@@ -89,6 +113,10 @@ private:
   AnalysisResult *getOrCreateAlgorithmResult(const AlgorithmId *Id,
       AlgorithmFn Fn);
   AnalysisResult *getAlgorithmResultOrNull(const AlgorithmId *Id) const;
+  // Like getAlgorithmResultOrNull, but first builds the result from the
+  // relations if there are any that could give it content.
+  AnalysisResult *getAlgorithmResultIfAny(const AlgorithmId *Id,
+      AlgorithmFn Fn);
 
   void addInstructionAnalysisWorkInternal(const AlgorithmId *Id1,
       AlgorithmFn Fn1, ValueInfo *that, const AlgorithmId *Id2,
@@ -108,7 +136,7 @@ template<>
 struct ValueInfo::GetAlgorithmResultHelper<true> {
   template<typename AlgorithmTy>
   static AnalysisResult *getAlgorithmResult(ValueInfo *VI) {
-    return VI->getAlgorithmResultOrNull(&AlgorithmTy::ID);
+    return VI->getAlgorithmResultIfAny(&AlgorithmTy::ID, &AlgorithmTy::run);
   }
 };
 
@@ -0,0 +1,58 @@
+; Alias classes precomputed for small finished sets answer the same as
+; queries on the sets themselves, also when sets are too large for a class or
+; there are too few classes for all of them.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-alias-classes -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-alias-classes -andersen-alias-class-max-set-size=1 -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-alias-classes -andersen-max-alias-classes=1 -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-alias-classes -andersen-lazy-relations -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@g = internal global i32* null
+@h = internal global i32* null
+
+; %l1 and %l2 have equal sets of two elements, %m a set of one, and %s a set
+; that overlaps both.
+define void @f(i1 %c) {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %d = alloca i32
+  store i32* %a, i32** @g
+  store i32* %b, i32** @g
+  store i32* %d, i32** @h
+  %l1 = load i32** @g
+  %l2 = load i32** @g
+  %m = load i32** @h
+  %s = select i1 %c, i32* %a, i32* %d
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %d
+  store i32 0, i32* %l1
+  store i32 0, i32* %l2
+  store i32 0, i32* %m
+  store i32 0, i32* %s
+  ret void
+}
+
+; CHECK: Function: f:
+; CHECK: NoAlias: i32* %a, i32* %b
+; CHECK: NoAlias: i32* %a, i32* %d
+; CHECK: NoAlias: i32* %b, i32* %d
+; CHECK: MayAlias: i32* %a, i32* %l1
+; CHECK: MayAlias: i32* %b, i32* %l1
+; CHECK: NoAlias: i32* %d, i32* %l1
+; CHECK: MayAlias: i32* %a, i32* %l2
+; CHECK: MayAlias: i32* %b, i32* %l2
+; CHECK: NoAlias: i32* %d, i32* %l2
+; CHECK: MayAlias: i32* %l1, i32* %l2
+; CHECK: NoAlias: i32* %a, i32* %m
+; CHECK: NoAlias: i32* %b, i32* %m
+; CHECK: MayAlias: i32* %d, i32* %m
+; CHECK: NoAlias: i32* %l1, i32* %m
+; CHECK: NoAlias: i32* %l2, i32* %m
+; CHECK: MayAlias: i32* %a, i32* %s
+; CHECK: NoAlias: i32* %b, i32* %s
+; CHECK: MayAlias: i32* %d, i32* %s
+; CHECK: MayAlias: i32* %l1, i32* %s
+; CHECK: MayAlias: i32* %l2, i32* %s
+; CHECK: MayAlias: i32* %m, i32* %s
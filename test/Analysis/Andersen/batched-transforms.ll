@@ -0,0 +1,75 @@
+; A transform takes every element of its input that is already known in one
+; batch. The batches here have duplicate subsets, an element that transforms
+; to the empty set, and an input that grows while its batch is applied, and
+; answer the same whichever way the sets are built.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-non-lazy -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-unification=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-unification=false -andersen-share-transforms=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@p1 = internal global i32* null
+@p2 = internal global i32* null
+@p3 = internal global i32* null
+@p4 = internal global i32* null
+@g = internal global i32** null
+@h = internal global i32** null
+@n1 = internal global i8* null
+@n2 = internal global i8* null
+@n3 = internal global i8* null
+
+define void @f(i1 %c) {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %d = alloca i32
+  store i32* %a, i32** @p1
+  store i32* %a, i32** @p2
+  store i32* %b, i32** @p4
+  store i32** @p1, i32*** @g
+  store i32** @p2, i32*** @g
+  store i32** @p3, i32*** @g
+  store i32** @p4, i32*** @g
+  store i32** @p3, i32*** @h
+  store i32 0, i32* %d
+  %x = load i32*** @g
+  %y = load i32** %x
+  store i32 0, i32* %y
+  %z = load i32*** @h
+  %w = load i32** %z
+  store i32 0, i32* %w
+  store i8* bitcast (i8** @n2 to i8*), i8** @n1
+  store i8* bitcast (i8** @n3 to i8*), i8** @n2
+  store i8* bitcast (i8** @n1 to i8*), i8** @n3
+  br label %loop
+
+loop:
+  %cur = phi i8* [ bitcast (i8** @n1 to i8*), %entry ], [ %next, %loop ]
+  %pp = bitcast i8* %cur to i8**
+  %next = load i8** %pp
+  store i8 0, i8* %next
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; CHECK: Function: f:
+; CHECK: MayAlias: i32** %x, i32** @p1
+; CHECK: MayAlias: i32** %x, i32** @p3
+; CHECK: MayAlias: i32* %a, i32* %y
+; CHECK: MayAlias: i32* %b, i32* %y
+; CHECK: NoAlias: i32* %d, i32* %y
+; CHECK: NoAlias: i32* %y, i32** @p1
+; CHECK: NoAlias: i32** %z, i32** @p1
+; CHECK: MayAlias: i32** %z, i32** @p3
+; CHECK: MayAlias: i32** %x, i32** %z
+; CHECK: NoAlias: i32* %a, i32* %w
+; CHECK: NoAlias: i32* %b, i32* %w
+; CHECK: NoAlias: i32* %w, i32* %y
+; CHECK: NoAlias: i32* %a, i8* %cur
+; CHECK: NoAlias: i32** @p1, i8* %cur
+; CHECK: MayAlias: i8* %cur, i8** @n2
+; CHECK: MayAlias: i8* %next, i8** @n2
+; CHECK: MayAlias: i8* %cur, i8* %next
+; CHECK: MayAlias: i8* %cur, i8** %pp
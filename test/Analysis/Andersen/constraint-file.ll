@@ -0,0 +1,28 @@
+; Write the relations to a constraint file, solve it offline and check the
+; points-to sets. Then check that a header claiming more ids than the file can
+; hold is rejected rather than allocated.
+; RUN: opt -disable-output -andersen -andersen-write-constraints=%t.andc %s
+; RUN: llvm-andersen %t.andc | FileCheck %s
+; RUN: printf 'ANDC\002\000\000\000\377\377\377\377\000\000\000\000\001\000\000\000' > %t.bad
+; RUN: not llvm-andersen %t.bad 2>&1 | FileCheck -check-prefix=BAD %s
+
+@g = global i32 0
+@p = global i32* null
+
+define internal void @f() {
+entry:
+  %x = alloca i32
+  %y = alloca i32
+  %q = alloca i32*
+  store i32* %x, i32** %q
+  store i32* @g, i32** @p
+  %l = load i32** %q
+  %m = load i32** @p
+  ret void
+}
+
+; CHECK: ExternallyAccessibleRegions = { #{{[0-9]+}} ExternallyLinkableRegions, #{{[0-9]+}} @g, #{{[0-9]+}} @p }
+; CHECK: @f:%l = { #{{[0-9]+}} @f:%x }
+; CHECK: @f:%m = { #{{[0-9]+}} ExternallyLinkableRegions, #{{[0-9]+}} @g, #{{[0-9]+}} @p }
+
+; BAD: more ids than the constraint file can hold
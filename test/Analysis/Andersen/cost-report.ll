@@ -0,0 +1,63 @@
+; The cost report charges the enumeration work to the functions whose
+; relations induced it, most first, and turning it on, which stops the
+; sharing of transforms, leaves the answers as they are.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-cost-report=%t -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: FileCheck -check-prefix=REPORT %s < %t
+; RUN: opt -andersen-cost-report=%t -andersen-cost-report-max-functions=1 -andersen-aa -aa-eval -disable-output %s 2>/dev/null
+; RUN: FileCheck -check-prefix=FIRST %s < %t
+; RUN: opt -andersen-unification=false -andersen-cost-report=%t -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@g = internal global i32* null
+@h = internal global i32* null
+
+define void @fill() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %c = alloca i32
+  %d = alloca i32
+  store i32* %a, i32** @g
+  store i32* %b, i32** @g
+  store i32* %c, i32** @g
+  store i32* %d, i32** @g
+  ret void
+}
+
+define void @copy() {
+entry:
+  %l = load i32** @g
+  store i32* %l, i32** @h
+  ret void
+}
+
+define void @use() {
+entry:
+  %x = alloca i32
+  store i32* %x, i32** @g
+  %m = load i32** @h
+  store i32 0, i32* %m
+  store i32 0, i32* %x
+  ret void
+}
+
+; CHECK: Function: fill:
+; CHECK: NoAlias: i32* %a, i32* %b
+; CHECK: NoAlias: i32* %c, i32* %d
+; CHECK: Function: copy:
+; CHECK: NoAlias: i32* %l, i32** @h
+; CHECK: Function: use:
+; CHECK: MayAlias: i32* %m, i32* %x
+; CHECK: NoAlias: i32* %m, i32** @h
+
+; REPORT: Enumeration work induced by the relations of each function
+; REPORT-NEXT: elements transforms total function
+; REPORT-NEXT: 15 2 17 use
+; REPORT-NEXT: 10 2 12 copy
+; REPORT-NEXT: 4 0 4 fill
+; REPORT-NEXT: 29 4 33 <total>
+
+; FIRST: elements transforms total function
+; FIRST-NEXT: 15 2 17 use
+; FIRST-NEXT: ... 2 more
+; FIRST-NEXT: 29 4 33 <total>
@@ -0,0 +1,27 @@
+; Explain why a region is in a points-to set, including the relation that
+; made one set a subset of another, with relations built lazily and eagerly.
+; RUN: opt -disable-output -andersen-record-derivations -andersen-explain-set=@f:%r -andersen-explain-element=@f:%x -explain-andersen %s | FileCheck %s
+; RUN: opt -disable-output -andersen-lazy-relations -andersen-record-derivations -andersen-explain-set=@f:%r -andersen-explain-element=@f:%x -explain-andersen %s | FileCheck %s
+
+define internal i32* @id(i32* %a) {
+entry:
+  ret i32* %a
+}
+
+define internal void @f() {
+entry:
+  %x = alloca i32
+  %q = alloca i32*
+  store i32* %x, i32** %q
+  %l = load i32** %q
+  %r = call i32* @id(i32* %l)
+  ret void
+}
+
+; CHECK: Why @f:%x is in the points-to set of @f:%r:
+; CHECK-NEXT: Element {{.*}} (x)
+; CHECK-NEXT: is in self({{.*}} (r))
+; CHECK-NEXT: because the returned-from-callee relation from {{.*}} (r) to {{.*}} (id) makes it include
+; CHECK-NEXT: is in actual-return-value o self({{.*}} (id))
+; CHECK: is in self({{.*}} (x))
+; CHECK-NEXT: which held it when it was built from the relations
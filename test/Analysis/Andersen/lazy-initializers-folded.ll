@@ -0,0 +1,24 @@
+; A later pass can fold a load from a constant global into a constant that so
+; far only appears in a deferred initializer. Queries on that constant must
+; analyze the initializer first instead of treating the constant as pointing
+; to nothing, which would let GVN forward the first store past the second.
+; RUN: opt -S -basicaa -andersen-aa -andersen-lazy-initializers -gvn %s | FileCheck %s
+; RUN: opt -S -basicaa -andersen-aa -gvn %s | FileCheck %s
+
+@arr = internal global [2 x i32] zeroinitializer
+@p = internal constant i32* getelementptr inbounds ([2 x i32]* @arr, i32 0, i32 1)
+
+define i32 @f(i1 %c) {
+entry:
+  %a = alloca i32
+  %q = load i32** @p
+  %s = select i1 %c, i32* %q, i32* %a
+  store i32 1, i32* %q
+  store i32 2, i32* %s
+  %v = load i32* %q
+  ret i32 %v
+}
+
+; CHECK: define i32 @f
+; CHECK: %v = load i32*
+; CHECK: ret i32 %v
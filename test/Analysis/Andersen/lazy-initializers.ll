@@ -0,0 +1,28 @@
+; Aggregate global initializers whose relations are only added when a load
+; first needs them give the same alias answers as ones analyzed up front.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-lazy-initializers -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-lazy-initializers -andersen-unification=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@x = internal global i32 0
+@y = internal global i32 0
+@z = internal global i32 0
+@table = internal global [2 x i32*] [i32* @x, i32* @y]
+@unused = internal global [1 x i32*] [i32* @z]
+
+define void @f(i64 %i) {
+entry:
+  %p = getelementptr [2 x i32*]* @table, i64 0, i64 %i
+  %e = load i32** %p
+  store i32 0, i32* %e
+  store i32 0, i32* @x
+  store i32 0, i32* @y
+  store i32 0, i32* @z
+  ret void
+}
+
+; CHECK: Function: f:
+; CHECK: MayAlias: i32* %e, i32* @x
+; CHECK: MayAlias: i32* %e, i32* @y
+; CHECK: NoAlias: i32* @x, i32* @y
+; CHECK: NoAlias: i32* %e, i32* @z
@@ -0,0 +1,41 @@
+; Results built lazily from the recorded relations answer the same as results
+; built by instruction analysis, with and without unification in front and
+; with and without sharing the transforms of equal inputs.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-unification=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-share-transforms=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@g = internal global i32* null
+
+define internal i32* @id(i32* %p) {
+  ret i32* %p
+}
+
+define void @f() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %c = alloca i32
+  store i32* %a, i32** @g
+  %l = load i32** @g
+  %r = call i32* @id(i32* %b)
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %c
+  store i32 0, i32* %l
+  store i32 0, i32* %r
+  ret void
+}
+
+; CHECK: Function: f:
+; CHECK: NoAlias: i32* %a, i32* %b
+; CHECK: NoAlias: i32* %a, i32* %c
+; CHECK: NoAlias: i32* %b, i32* %c
+; CHECK: MayAlias: i32* %a, i32* %l
+; CHECK: NoAlias: i32* %b, i32* %l
+; CHECK: NoAlias: i32* %c, i32* %l
+; CHECK: NoAlias: i32* %a, i32* %r
+; CHECK: MayAlias: i32* %b, i32* %r
+; CHECK: NoAlias: i32* %c, i32* %r
+; CHECK: NoAlias: i32* %l, i32* %r
@@ -0,0 +1,58 @@
+# Finished intermediate results discarded under -andersen-max-memory and
+# computed again answer the same as results that are kept. Each @g holds the
+# @r globals and the @s globals of the steps before it, enough set elements
+# to go over a limit of one megabyte several times.
+# RUN: python %s > %t.ll
+# RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %t.ll 2> %t.default
+# RUN: opt -andersen-max-memory=1 -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %t.ll 2> %t.limited
+# RUN: diff %t.default %t.limited
+# RUN: opt -andersen-max-memory=1 -andersen-lazy-relations=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %t.ll 2> %t.nonlazy
+# RUN: diff %t.default %t.nonlazy
+# RUN: FileCheck %s < %t.limited
+#
+# CHECK: Function: use
+# CHECK: MayAlias: i32* %l0, i32* %l64
+# CHECK: NoAlias: i32* %l0, i32* @s0
+# CHECK: MayAlias: i32* %l8, i32* @s0
+# CHECK: NoAlias: i32* %l56, i32* @s56
+# CHECK: MayAlias: i32* %l64, i32* @s56
+regions = 256
+steps = 64
+
+for i in range(regions):
+    print('@r%d = internal global i32 0' % i)
+for j in range(steps):
+    print('@s%d = internal global i32 0' % j)
+for j in range(steps + 1):
+    print('@g%d = internal global i32* null' % j)
+
+# Sixteen stores to a function keep the alias queries within each small.
+for f in range(regions // 16):
+    print('')
+    print('define void @init%d() {' % f)
+    print('entry:')
+    for i in range(f * 16, f * 16 + 16):
+        print('  store i32* @r%d, i32** @g0' % i)
+    print('  ret void')
+    print('}')
+
+for j in range(steps):
+    print('')
+    print('define void @step%d() {' % j)
+    print('entry:')
+    print('  %%p = load i32** @g%d' % j)
+    print('  store i32* %%p, i32** @g%d' % (j + 1))
+    print('  store i32* @s%d, i32** @g%d' % (j, j + 1))
+    print('  ret void')
+    print('}')
+
+print('')
+print('define void @use() {')
+print('entry:')
+for j in range(0, steps + 1, 8):
+    print('  %%l%d = load i32** @g%d' % (j, j))
+    print('  store i32 0, i32* %%l%d' % j)
+for j in range(0, steps, 8):
+    print('  store i32 0, i32* @s%d' % j)
+print('  ret void')
+print('}')
@@ -0,0 +1,39 @@
+; A query that runs out of its enumeration budget falls back to the next alias
+; analysis, which says MayAlias here, instead of answering from a partly
+; computed set. A budget large enough for every query changes nothing.
+; RUN: opt -andersen-unification=false -andersen-query-budget=1 -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck -check-prefix=BUDGET %s
+; RUN: opt -andersen-unification=false -andersen-query-budget=100000 -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@g = internal global i32* null
+
+define internal i32* @id(i32* %p) {
+  ret i32* %p
+}
+
+define void @f() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %c = alloca i32
+  store i32* %a, i32** @g
+  %l = load i32** @g
+  %r = call i32* @id(i32* %b)
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %c
+  store i32 0, i32* %l
+  store i32 0, i32* %r
+  ret void
+}
+
+; BUDGET: Function: f:
+; BUDGET: NoAlias: i32* %a, i32* %b
+; BUDGET: MayAlias: i32* %b, i32* %l
+; BUDGET: MayAlias: i32* %c, i32* %r
+; BUDGET: MayAlias: i32* %l, i32* %r
+
+; CHECK: Function: f:
+; CHECK: NoAlias: i32* %a, i32* %b
+; CHECK: NoAlias: i32* %b, i32* %l
+; CHECK: NoAlias: i32* %c, i32* %r
+; CHECK: NoAlias: i32* %l, i32* %r
@@ -0,0 +1,38 @@
+; The trace keeps a span for every query, even when it keeps no enumeration
+; spans, and writes enumeration spans nested as deep as it is told to.
+; RUN: opt -andersen-aa -andersen-trace=%t -aa-eval -disable-output %s 2>/dev/null
+; RUN: FileCheck %s < %t
+; RUN: opt -andersen-aa -andersen-trace=%t -andersen-trace-max-events=0 -aa-eval -disable-output %s 2>/dev/null
+; RUN: FileCheck %s < %t
+; RUN: opt -andersen-aa -andersen-trace=%t -andersen-trace-max-depth=100 -andersen-trace-min-duration=0 -aa-eval -disable-output %s 2>/dev/null
+; RUN: FileCheck -check-prefix=NESTED %s < %t
+
+@g = internal global i32* null
+
+define internal i32* @id(i32* %p) {
+  ret i32* %p
+}
+
+define void @f() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  store i32* %a, i32** @g
+  %l = load i32** @g
+  %r = call i32* @id(i32* %b)
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %l
+  store i32 0, i32* %r
+  ret void
+}
+
+; CHECK: {"traceEvents":[
+; CHECK: {"name":"doPointsToSetsIntersect","cat":"query"
+; CHECK: ],"displayTimeUnit":"ms","otherData":{"dropped":
+
+; NESTED: {"traceEvents":[
+; NESTED: "cat":"enumerate"
+; NESTED: "args":{"depth":1}}
+; NESTED: {"name":"doPointsToSetsIntersect","cat":"query"
+; NESTED: "otherData":{"dropped":0}}
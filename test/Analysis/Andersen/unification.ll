@@ -0,0 +1,37 @@
+; Sets in different unification classes are disjoint without enumeration,
+; and sets that unification merges, like those of %p and %q through the
+; select, are still told apart by enumeration. Unification must not change
+; any answer.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-unification=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+define void @f(i1 %c) {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %x = alloca i32
+  %y = alloca i32
+  %p = getelementptr i32* %a, i64 0
+  %q = getelementptr i32* %b, i64 0
+  %s = select i1 %c, i32* %p, i32* %q
+  store i32 0, i32* %p
+  store i32 0, i32* %q
+  store i32 0, i32* %s
+  store i32 0, i32* %x
+  store i32 0, i32* %y
+  ret void
+}
+
+; CHECK: Function: f:
+; CHECK: NoAlias: i32* %a, i32* %b
+; CHECK: NoAlias: i32* %x, i32* %y
+; CHECK: NoAlias: i32* %b, i32* %p
+; CHECK: NoAlias: i32* %p, i32* %x
+; CHECK: NoAlias: i32* %a, i32* %q
+; CHECK: NoAlias: i32* %p, i32* %q
+; CHECK: MayAlias: i32* %a, i32* %s
+; CHECK: MayAlias: i32* %b, i32* %s
+; CHECK: NoAlias: i32* %s, i32* %x
+; CHECK: MayAlias: i32* %p, i32* %s
+; CHECK: MayAlias: i32* %q, i32* %s
@@ -0,0 +1,42 @@
+; Sets that hold the universe of escaped memory hold it by a flag instead of
+; listing its elements. Queries against them, one at a time or through the
+; finished forms of non-lazy mode and alias classes, answer the same.
+; RUN: opt -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-lazy-relations -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-non-lazy -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-alias-classes -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+; RUN: opt -andersen-unification=false -andersen-aa -aa-eval -print-all-alias-modref-info -disable-output %s 2>&1 | FileCheck %s
+
+@ext = global i32* null
+
+declare i32* @unknown(i32*)
+
+; %a escapes through @ext and %b through the call, so %u and %l, which point
+; to the universe, can be either of them, but not %c.
+define void @f() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  %c = alloca i32
+  store i32* %a, i32** @ext
+  %u = call i32* @unknown(i32* %b)
+  %l = load i32** @ext
+  store i32 0, i32* %a
+  store i32 0, i32* %b
+  store i32 0, i32* %c
+  store i32 0, i32* %u
+  store i32 0, i32* %l
+  ret void
+}
+
+; CHECK: Function: f:
+; CHECK: NoAlias: i32* %a, i32* %b
+; CHECK: NoAlias: i32* %a, i32* %c
+; CHECK: NoAlias: i32* %b, i32* %c
+; CHECK: MayAlias: i32* %a, i32* %u
+; CHECK: MayAlias: i32* %b, i32* %u
+; CHECK: NoAlias: i32* %c, i32* %u
+; CHECK: MayAlias: i32* %a, i32* %l
+; CHECK: MayAlias: i32* %b, i32* %l
+; CHECK: NoAlias: i32* %c, i32* %l
+; CHECK: MayAlias: i32* %l, i32* %u
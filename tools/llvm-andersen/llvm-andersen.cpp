@@ -0,0 +1,61 @@
+//===-- llvm-andersen.cpp - Solve Andersen constraint files ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program solves the constraint files written by opt with
+// -andersen-write-constraints and prints the points-to sets, without loading
+// any IR.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Analysis/AndersenConstraints.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/system_error.h"
+#include <string>
+using namespace llvm;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<constraint file>"), cl::init("-"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
+               cl::init("-"));
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+  cl::ParseCommandLineOptions(argc, argv, "Andersen constraint solver\n");
+
+  OwningPtr<MemoryBuffer> Buffer;
+  if (error_code ec = MemoryBuffer::getFileOrSTDIN(InputFilename, Buffer)) {
+    errs() << argv[0] << ": " << InputFilename << ": " << ec.message() << '\n';
+    return 1;
+  }
+
+  std::string ErrorInfo;
+  raw_fd_ostream Out(OutputFilename.c_str(), ErrorInfo);
+  if (!ErrorInfo.empty()) {
+    errs() << argv[0] << ": " << ErrorInfo << '\n';
+    return 1;
+  }
+
+  if (!solveAndersenConstraints(Buffer->getBuffer(), Out, ErrorInfo)) {
+    errs() << argv[0] << ": " << InputFilename << ": " << ErrorInfo << '\n';
+    return 1;
+  }
+  return 0;
+}
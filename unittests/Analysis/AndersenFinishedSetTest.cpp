@@ -0,0 +1,163 @@
+//===- AndersenFinishedSetTest.cpp - FinishedSet unit tests ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "../lib/Analysis/Andersen/FinishedSet.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace llvm {
+namespace andersen_internal {
+namespace {
+
+// Large enough that sets of a few hundred ids are stored as sorted arrays.
+const uint32_t ManyValueInfos = 1 << 20;
+
+// The ids from First up to Last, stepping by Step.
+std::vector<uint32_t> range(uint32_t First, uint32_t Last, uint32_t Step = 1) {
+  std::vector<uint32_t> Ids;
+  for (uint32_t Id = First; Id <= Last; Id += Step) {
+    Ids.push_back(Id);
+  }
+  return Ids;
+}
+
+// Whether A and B have an element in common, the slow way.
+bool intersectsSlowly(std::vector<uint32_t> A, std::vector<uint32_t> B) {
+  std::sort(A.begin(), A.end());
+  std::sort(B.begin(), B.end());
+  std::vector<uint32_t> Common;
+  std::set_intersection(A.begin(), A.end(), B.begin(), B.end(),
+                        std::back_inserter(Common));
+  return !Common.empty();
+}
+
+// Build finished sets of A and B, which the constructor consumes, and check
+// that they intersect exactly when the lists do, in both directions.
+void expectIntersection(std::vector<uint32_t> A, std::vector<uint32_t> B,
+                        uint32_t NumA = ManyValueInfos,
+                        uint32_t NumB = ManyValueInfos) {
+  bool Expected = intersectsSlowly(A, B);
+  FinishedSet SetA(A, NumA), SetB(B, NumB);
+  EXPECT_EQ(Expected, SetA.intersects(SetB));
+  EXPECT_EQ(Expected, SetB.intersects(SetA));
+}
+
+TEST(AndersenFinishedSetTest, SkewedSizes) {
+  // 512 ids against two to four gallop through the larger array.
+  std::vector<uint32_t> Large = range(1000, 1000 + 2 * 511, 2);
+  expectIntersection(range(1, 3), Large);
+  expectIntersection(range(1001, 1003, 2), Large);
+  std::vector<uint32_t> First;
+  First.push_back(1);
+  First.push_back(5);
+  First.push_back(1000);
+  expectIntersection(First, Large);
+  std::vector<uint32_t> Last;
+  Last.push_back(999);
+  Last.push_back(1501);
+  Last.push_back(1001 + 2 * 510);
+  Last.push_back(1000 + 2 * 511);
+  expectIntersection(Last, Large);
+  std::vector<uint32_t> Past;
+  Past.push_back(1999);
+  Past.push_back(2023);
+  Past.push_back(5000);
+  expectIntersection(Past, Large);
+}
+
+TEST(AndersenFinishedSetTest, TailsShorterThanABlock) {
+  // Blocks of four are compared together, and the rest one at a time. The
+  // only common element is in the tail of one or both arrays.
+  for (uint32_t ASize = 1; ASize != 12; ++ASize) {
+    for (uint32_t BSize = 1; BSize != 12; ++BSize) {
+      std::vector<uint32_t> A = range(0, 2 * (ASize - 1), 2);
+      std::vector<uint32_t> B = range(1, 2 * BSize - 1, 2);
+      expectIntersection(A, B);
+      B.back() = A.back();
+      std::sort(B.begin(), B.end());
+      expectIntersection(A, B);
+    }
+  }
+}
+
+TEST(AndersenFinishedSetTest, BitmapsOfDifferentLengths) {
+  // Sets built at different times see different numbers of ValueInfos, so
+  // one bitmap can have more words than the other.
+  std::vector<uint32_t> Short = range(0, 63, 2);
+  std::vector<uint32_t> Long = range(65, 255, 2);
+  expectIntersection(Short, Long, 64, 256);
+  Long.push_back(62);
+  expectIntersection(Short, Long, 64, 256);
+
+  // A bitmap against a sorted array with ids past the end of the bitmap.
+  std::vector<uint32_t> Sparse;
+  Sparse.push_back(100);
+  Sparse.push_back(ManyValueInfos - 1);
+  expectIntersection(Short, Sparse, 64);
+  Sparse.push_back(2);
+  expectIntersection(Short, Sparse, 64);
+}
+
+TEST(AndersenFinishedSetTest, SetsThatHoldTheUniverse) {
+  std::vector<uint32_t> UniverseIds = range(10, 19);
+  FinishedSet Universe(UniverseIds, 100);
+
+  // Listing every element of the universe represents it implicitly.
+  std::vector<uint32_t> Ids = range(10, 21);
+  FinishedSet Whole(Ids, 100, &Universe);
+  EXPECT_TRUE(Whole.containsUniverse());
+  EXPECT_TRUE(Whole.contains(15));
+  EXPECT_TRUE(Whole.contains(21));
+  EXPECT_FALSE(Whole.contains(22));
+
+  // Holding it by a flag does too, without listing its elements.
+  std::vector<uint32_t> Flagged;
+  Flagged.push_back(50);
+  FinishedSet Holder(Flagged, 100, &Universe, true);
+  EXPECT_TRUE(Holder.containsUniverse());
+  EXPECT_TRUE(Holder.contains(10));
+  EXPECT_TRUE(Holder.contains(50));
+  EXPECT_FALSE(Holder.contains(20));
+
+  // Missing one element of the universe keeps every element explicit.
+  Ids = range(11, 21);
+  FinishedSet Partial(Ids, 100, &Universe);
+  EXPECT_FALSE(Partial.containsUniverse());
+  EXPECT_TRUE(Partial.contains(11));
+  EXPECT_FALSE(Partial.contains(10));
+
+  std::vector<uint32_t> InUniverse;
+  InUniverse.push_back(19);
+  FinishedSet OneOfUniverse(InUniverse, 100);
+  std::vector<uint32_t> Outside;
+  Outside.push_back(21);
+  FinishedSet OneOutside(Outside, 100);
+  std::vector<uint32_t> Elsewhere;
+  Elsewhere.push_back(70);
+  FinishedSet OneElsewhere(Elsewhere, 100);
+
+  EXPECT_TRUE(Whole.intersects(Holder));
+  EXPECT_TRUE(Holder.intersects(Whole));
+  EXPECT_TRUE(Holder.intersects(OneOfUniverse));
+  EXPECT_TRUE(OneOfUniverse.intersects(Holder));
+  EXPECT_TRUE(Whole.intersects(OneOutside));
+  EXPECT_FALSE(Holder.intersects(OneOutside));
+  EXPECT_FALSE(OneOutside.intersects(Holder));
+  EXPECT_FALSE(Whole.intersects(OneElsewhere));
+  EXPECT_TRUE(Partial.intersects(Whole));
+  EXPECT_FALSE(Partial.intersects(OneElsewhere));
+}
+
+}
+}
+}
@@ -0,0 +1,294 @@
+//===- AndersenTest.cpp - Andersen unit tests -----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/AndersenPass.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Assembly/Parser.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#include "../lib/Analysis/Andersen/ValueInfo.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace {
+
+const char Source[] =
+    "define void @f() {\n"
+    "entry:\n"
+    "  %a = alloca i32\n"
+    "  %b = alloca i32\n"
+    "  store i32 0, i32* %a\n"
+    "  store i32 0, i32* %b\n"
+    "  ret void\n"
+    "}\n";
+
+const char BatchSource[] =
+    "@g = internal global i32* null\n"
+    "\n"
+    "define internal i32* @id(i32* %p) {\n"
+    "  ret i32* %p\n"
+    "}\n"
+    "\n"
+    "define void @f(i1 %c) {\n"
+    "entry:\n"
+    "  %a = alloca i32\n"
+    "  %b = alloca i32\n"
+    "  store i32* %a, i32** @g\n"
+    "  %l = load i32** @g\n"
+    "  %r = call i32* @id(i32* %b)\n"
+    "  %s = select i1 %c, i32* %l, i32* %r\n"
+    "  %t = call i32* @id(i32* %s)\n"
+    "  store i32 0, i32* %t\n"
+    "  ret void\n"
+    "}\n";
+
+// Build a module in which each of the loads of @g can point to any of the
+// allocas, so that the thread has sets to solve while queries run.
+std::string makeBackgroundSource() {
+  std::string Asm;
+  raw_string_ostream OS(Asm);
+  OS << "@g = internal global i32* null\n\n"
+     << "define void @f() {\n"
+     << "entry:\n";
+  for (unsigned i = 0; i != 64; ++i) {
+    OS << "  %a" << i << " = alloca i32\n"
+       << "  store i32* %a" << i << ", i32** @g\n";
+  }
+  for (unsigned i = 0; i != 64; ++i) {
+    OS << "  %l" << i << " = load i32** @g\n";
+  }
+  OS << "  ret void\n"
+     << "}\n";
+  return OS.str();
+}
+
+// The Values of the elements from Begin to End, in order of address. The sets
+// of two analyses of one module hold different ValueInfos for the same Values.
+template <typename IteratorTy>
+std::vector<const Value *> getSortedValues(IteratorTy Begin, IteratorTy End) {
+  std::vector<const Value *> Values;
+  for (; Begin != End; ++Begin) {
+    Values.push_back((*Begin)->getValue());
+  }
+  std::sort(Values.begin(), Values.end());
+  return Values;
+}
+
+// We use this fixture to ensure that the results of the pass are released
+// before the Module is deleted. Its overrides of the Pass methods are private.
+class AndersenTest : public testing::Test {
+protected:
+  AndersenTest() : AP(new AndersenPass), Reference(new AndersenPass) {}
+  ~AndersenTest() {
+    static_cast<Pass &>(*AP).releaseMemory();
+    static_cast<Pass &>(*Reference).releaseMemory();
+  }
+
+  // Parse Asm and analyze it with both passes.
+  void analyze(const char *Asm) {
+    SMDiagnostic Err;
+    M.reset(ParseAssemblyString(Asm, 0, Err, Context));
+    ASSERT_TRUE(M);
+    static_cast<ModulePass &>(*AP).runOnModule(*M);
+    static_cast<ModulePass &>(*Reference).runOnModule(*M);
+  }
+
+  // Read Source in lazily and analyze it, discarding the bodies afterwards.
+  void analyzeLazily() {
+    SMDiagnostic Err;
+    OwningPtr<Module> Parsed(ParseAssemblyString(Source, 0, Err, Context));
+    ASSERT_TRUE(Parsed);
+    SmallString<1024> Mem;
+    raw_svector_ostream OS(Mem);
+    WriteBitcodeToFile(Parsed.get(), OS);
+    OS.flush();
+    MemoryBuffer *Buffer = MemoryBuffer::getMemBuffer(Mem.str(), "test",
+                                                      false);
+    std::string ErrMsg;
+    M.reset(getLazyBitcodeModule(Buffer, Context, &ErrMsg));
+    ASSERT_TRUE(M) << ErrMsg;
+
+    StringMap<cl::Option *> Options;
+    cl::getRegisteredOptions(Options);
+    ASSERT_EQ(1u, Options.count("andersen-dematerialize"));
+    cl::opt<bool> &Dematerialize =
+        *static_cast<cl::opt<bool> *>(Options["andersen-dematerialize"]);
+    Dematerialize = true;
+    static_cast<ModulePass &>(*AP).runOnModule(*M);
+    Dematerialize = false;
+  }
+
+  // Parse Asm and analyze it with both passes, leaving a background solver
+  // running on AP that yields after every unit of work.
+  void analyzeInBackground(const char *Asm) {
+    StringMap<cl::Option *> Options;
+    cl::getRegisteredOptions(Options);
+    ASSERT_EQ(1u, Options.count("andersen-background"));
+    ASSERT_EQ(1u, Options.count("andersen-background-chunk"));
+    SMDiagnostic Err;
+    M.reset(ParseAssemblyString(Asm, 0, Err, Context));
+    ASSERT_TRUE(M);
+    static_cast<ModulePass &>(*Reference).runOnModule(*M);
+
+    // Set the options as the command line would, without counting another
+    // occurrence each time.
+    cl::Option *Background = Options["andersen-background"];
+    cl::opt<unsigned> &Chunk =
+        *static_cast<cl::opt<unsigned> *>(Options["andersen-background-chunk"]);
+    unsigned OldChunk = Chunk;
+    ASSERT_FALSE(Background->addOccurrence(0, "andersen-background",
+                                           "referenced", true));
+    Chunk = 1;
+    static_cast<ModulePass &>(*AP).runOnModule(*M);
+    Background->addOccurrence(0, "andersen-background", "none", true);
+    Chunk = OldChunk;
+  }
+
+  LLVMContext Context;
+  OwningPtr<Module> M;
+  OwningPtr<AndersenPass> AP;
+  // A second analysis of the same module, for comparing against answers
+  // computed one query at a time.
+  OwningPtr<AndersenPass> Reference;
+};
+
+TEST_F(AndersenTest, LookupInBodyReadInAgain) {
+  analyzeLazily();
+  Function *F = M->getFunction("f");
+  ASSERT_TRUE(F);
+  ASSERT_TRUE(F->isMaterializable()) << "The body was not discarded";
+  std::string ErrMsg;
+  ASSERT_FALSE(F->Materialize(&ErrMsg)) << ErrMsg;
+
+  BasicBlock &Entry = F->getEntryBlock();
+  BasicBlock::iterator i = Entry.begin();
+  Instruction *A = &*i++;
+  Instruction *B = &*i;
+  AndersenHandle HA, HB;
+  ASSERT_TRUE(AP->getHandleToPointsToSet(A, HA));
+  ASSERT_TRUE(AP->getHandleToPointsToSet(B, HB));
+  EXPECT_FALSE(AP->doPointsToSetsIntersect(HA, HB));
+
+  // A pass adding an instruction moves the others, so none of them can be
+  // found by position any more.
+  Instruction *C = new AllocaInst(Type::getInt32Ty(Context), "c", A);
+  AndersenHandle HC;
+  EXPECT_FALSE(AP->getHandleToPointsToSet(C, HC));
+  EXPECT_FALSE(AP->getHandleToPointsToSet(A, HA));
+  EXPECT_FALSE(AP->getHandleToPointsToSet(B, HB));
+
+  // Replacing it by one of another kind keeps the positions, but not the
+  // opcodes.
+  Instruction *D = new LoadInst(Constant::getNullValue(A->getType()), "d", C);
+  C->eraseFromParent();
+  EXPECT_FALSE(AP->getHandleToPointsToSet(A, HA));
+
+  D->eraseFromParent();
+  EXPECT_TRUE(AP->getHandleToPointsToSet(A, HA));
+  EXPECT_TRUE(AP->getHandleToPointsToSet(B, HB));
+  EXPECT_FALSE(AP->doPointsToSetsIntersect(HA, HB));
+}
+
+TEST_F(AndersenTest, BatchQueriesMatchSingleOnes) {
+  analyze(BatchSource);
+  Function *F = M->getFunction("f");
+  ASSERT_TRUE(F);
+  std::vector<const Value *> Values;
+  for (BasicBlock::iterator i = F->getEntryBlock().begin(),
+                            End = F->getEntryBlock().end();
+       i != End; ++i) {
+    if (i->getType()->isPointerTy()) {
+      Values.push_back(&*i);
+    }
+  }
+  Values.push_back(M->getNamedGlobal("g"));
+  ASSERT_EQ(7u, Values.size());
+
+  std::vector<PointsToSetView> Sets(Values.size());
+  AP->getPointsToSets(Values, Sets);
+  std::vector<std::pair<const Value *, const Value *> > Pairs;
+  for (size_t i = 0, End = Values.size(); i != End; ++i) {
+    const PointsToSet *Single = Reference->getPointsToSet(
+        Reference->getHandleToPointsToSet(Values[i]));
+    std::vector<const Value *> Expected;
+    if (Single) {
+      Expected = getSortedValues(Single->begin(), Single->end());
+    }
+    EXPECT_EQ(Expected, getSortedValues(Sets[i].begin(), Sets[i].end()));
+    for (size_t j = i + 1; j != End; ++j) {
+      Pairs.push_back(std::make_pair(Values[i], Values[j]));
+    }
+  }
+
+  bool Results[21];
+  ASSERT_EQ(array_lengthof(Results), Pairs.size());
+  AP->doPointsToSetsIntersect(Pairs, Results);
+  for (size_t i = 0, End = Pairs.size(); i != End; ++i) {
+    EXPECT_EQ(Reference->doPointsToSetsIntersect(
+                  Reference->getHandleToPointsToSet(Pairs[i].first),
+                  Reference->getHandleToPointsToSet(Pairs[i].second)),
+              Results[i]);
+  }
+  // %a and %b, then %a and %l.
+  EXPECT_FALSE(Results[0]);
+  EXPECT_TRUE(Results[1]);
+}
+
+TEST_F(AndersenTest, QueriesDuringBackgroundSolving) {
+  std::string Asm = makeBackgroundSource();
+  analyzeInBackground(Asm.c_str());
+  Function *F = M->getFunction("f");
+  ASSERT_TRUE(F);
+  std::vector<const Value *> Values;
+  for (BasicBlock::iterator i = F->getEntryBlock().begin(),
+                            End = F->getEntryBlock().end();
+       i != End; ++i) {
+    if (i->getType()->isPointerTy()) {
+      Values.push_back(&*i);
+    }
+  }
+  ASSERT_EQ(128u, Values.size());
+
+  // Read views of the loads while the thread may be adding to their sets.
+  for (size_t i = 64, End = Values.size(); i != End; ++i) {
+    PointsToSetView SoFar = AP->getPointsToSetContentsSoFarView(
+        AP->getHandleToPointsToSet(Values[i]));
+    EXPECT_EQ(64, std::distance(SoFar.begin(), SoFar.end()));
+  }
+  for (size_t i = 0, End = Values.size(); i < End; i += 7) {
+    for (size_t j = i + 1; j < End; j += 5) {
+      EXPECT_EQ(Reference->doPointsToSetsIntersect(
+                    Reference->getHandleToPointsToSet(Values[i]),
+                    Reference->getHandleToPointsToSet(Values[j])),
+                AP->doPointsToSetsIntersect(
+                    AP->getHandleToPointsToSet(Values[i]),
+                    AP->getHandleToPointsToSet(Values[j])));
+    }
+  }
+}
+
+}
+}